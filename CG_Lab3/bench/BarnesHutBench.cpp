@@ -0,0 +1,48 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/BarnesHut.h"
+
+#include <cstdio>
+
+// barnes-hut [max bodies] [theta]
+int BenchBarnesHut(const std::vector<std::string> &args)
+{
+    size_t maxBodies = args.size() > 0 ? std::stoul(args[0]) : 1000000;
+    float theta = args.size() > 1 ? std::stof(args[1]) : 0.5f;
+
+    std::printf("%10s %8s %8s %12s %12s %12s\n", "bodies", "threads", "nodes", "build ms", "force ms", "steps/s");
+    for (size_t n = 1000; n <= maxBodies; n *= 10)
+    {
+        Bodies bodies;
+        MakeDisk(bodies, n);
+
+        for (unsigned threads : ThreadCounts())
+        {
+            ThreadPool pool(threads);
+            BarnesHut tree(pool, theta);
+            // warm up allocations
+            tree.Build(bodies);
+            tree.ComputeAccelerations(bodies);
+
+            int repeats = n <= 10000 ? 20 : (n <= 100000 ? 5 : 1);
+            double build = 0.0, force = 0.0;
+            for (int r = 0; r < repeats; ++r)
+            {
+                Timer timer;
+                tree.Build(bodies);
+                build += timer.Seconds();
+                timer.Reset();
+                tree.ComputeAccelerations(bodies);
+                force += timer.Seconds();
+            }
+            build /= repeats;
+            force /= repeats;
+            std::printf("%10zu %8u %8zu %12.3f %12.3f %12.2f\n", n, threads, tree.getNodeCount(),
+                        build * 1e3, force * 1e3, 1.0 / (build + force));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+
+void MakeDisk(Bodies &bodies, size_t n, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float centralMass = 8000.0f;
+
+    bodies.Clear();
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), centralMass, 5.0f);
+    for (size_t i = 1; i < n; ++i)
+    {
+        float r = 20.0f + 80.0f * unit(rng);
+        float angle = 2.0f * 3.14159265359f * unit(rng);
+        float h = (unit(rng) - 0.5f) * 2.0f;
+        float v = std::sqrt(GRAVITY * centralMass / r);
+        bodies.Add(glm::vec3(r * std::cos(angle), h, r * std::sin(angle)),
+                   glm::vec3(-v * std::sin(angle), 0.0f, v * std::cos(angle)),
+                   1e-3f, 0.05f);
+    }
+}
+
+std::vector<unsigned> ThreadCounts()
+{
+    unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < hw; t *= 2)
+        counts.push_back(t);
+    counts.push_back(hw);
+    return counts;
+}
+
+int main(int argc, char **argv)
+{
+    std::map<std::string, int (*)(const std::vector<std::string> &)> benches = {
+            { "barnes-hut", BenchBarnesHut },
+            { "direct-sum", BenchDirectSum },
+            { "kepler", BenchKepler },
+            { "integrators", BenchIntegrators },
+            { "ephemeris", BenchEphemeris },
+            { "collision", BenchCollision },
+            { "bvh", BenchBvh },
+            { "octree", BenchOctree },
+            { "predictor", BenchPredictor },
+            { "scheduler", BenchScheduler },
+            { "snapshot", BenchSnapshot },
+            { "keyframes", BenchKeyframes },
+            { "submission", BenchSubmission },
+    };
+
+    if (argc < 2 || benches.find(argv[1]) == benches.end())
+    {
+        std::cout << "usage: " << argv[0] << " <benchmark> [args]" << std::endl << "benchmarks:";
+        for (auto &bench : benches)
+            std::cout << " " << bench.first;
+        std::cout << std::endl;
+        return 1;
+    }
+
+    return benches[argv[1]](std::vector<std::string>(argv + 2, argv + argc));
+}
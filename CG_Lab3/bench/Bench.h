@@ -0,0 +1,48 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_BENCH_H
+#define PROJECT_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../src/Bodies.h"
+
+// wall clock stopwatch
+class Timer {
+private:
+    std::chrono::steady_clock::time_point mStart;
+public:
+    Timer() : mStart(std::chrono::steady_clock::now()) {}
+    inline void Reset() { this->mStart = std::chrono::steady_clock::now(); }
+    inline double Seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->mStart).count();
+    }
+};
+
+// central mass with n light bodies on circular orbits in a thick disk
+void MakeDisk(Bodies &bodies, size_t n, uint32_t seed = 1);
+
+// thread counts 1, 2, 4 ... up to the hardware concurrency
+std::vector<unsigned> ThreadCounts();
+
+// benchmarks, each gets the arguments that follow its name
+int BenchBarnesHut(const std::vector<std::string> &args);
+int BenchDirectSum(const std::vector<std::string> &args);
+int BenchKepler(const std::vector<std::string> &args);
+int BenchIntegrators(const std::vector<std::string> &args);
+int BenchEphemeris(const std::vector<std::string> &args);
+int BenchCollision(const std::vector<std::string> &args);
+int BenchBvh(const std::vector<std::string> &args);
+int BenchOctree(const std::vector<std::string> &args);
+int BenchPredictor(const std::vector<std::string> &args);
+int BenchScheduler(const std::vector<std::string> &args);
+int BenchSnapshot(const std::vector<std::string> &args);
+int BenchKeyframes(const std::vector<std::string> &args);
+int BenchSubmission(const std::vector<std::string> &args);
+
+
+#endif //PROJECT_BENCH_H
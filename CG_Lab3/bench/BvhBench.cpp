@@ -0,0 +1,123 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/Bvh.h"
+#include "../src/NBody.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// closest hit by testing every sphere
+static bool BruteForce(const Bodies &bodies, const glm::vec3 &origin, const glm::vec3 &direction, RayHit &hit)
+{
+    bool found = false;
+    hit.distance = INFINITY;
+    for (size_t i = 0; i < bodies.Size(); ++i)
+    {
+        glm::vec3 oc = bodies.Position(i) - origin;
+        float tca = glm::dot(oc, direction);
+        glm::vec3 perpendicular = oc - tca * direction;
+        float d2 = glm::dot(perpendicular, perpendicular);
+        float r2 = bodies.radius[i] * bodies.radius[i];
+        if (d2 > r2)
+            continue;
+        float thc = std::sqrt(r2 - d2);
+        float t = tca - thc >= 0.0f ? tca - thc : tca + thc;
+        if (t >= 0.0f && t < hit.distance) {
+            hit = { uint32_t(i), t };
+            found = true;
+        }
+    }
+    return found;
+}
+
+// bvh [bodies] [moved per frame]
+int BenchBvh(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 100000;
+    size_t movedCount = args.size() > 1 ? std::stoul(args[1]) : 16;
+
+    Bodies bodies;
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), 8000.0f, 5.0f);
+    AddBelt(bodies, 0, n - 1, 30.0f, 90.0f);
+
+    Bvh bvh;
+    Timer timer;
+    int repeats = 0;
+    do {
+        bvh.Build(bodies);
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    double build = timer.Seconds() / repeats;
+
+    // the whole belt moves a little
+    for (size_t i = 0; i < n; ++i)
+    {
+        bodies.x[i] += bodies.vx[i] * 0.01f;
+        bodies.z[i] += bodies.vz[i] * 0.01f;
+    }
+    timer.Reset();
+    repeats = 0;
+    do {
+        bvh.Refit(bodies);
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    double refit = timer.Seconds() / repeats;
+
+    // a few bodies move every frame
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<uint32_t> pick(1, uint32_t(n - 1));
+    std::vector<uint32_t> moved(movedCount);
+    timer.Reset();
+    repeats = 0;
+    do {
+        for (uint32_t &body : moved)
+        {
+            body = pick(rng);
+            bodies.x[body] += bodies.vx[body] * 0.01f;
+            bodies.z[body] += bodies.vz[body] * 0.01f;
+        }
+        bvh.Refit(bodies, moved);
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    double partial = timer.Seconds() / repeats;
+
+    // rays from a camera above the belt towards random points of it
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const int rays = 10000;
+    std::vector<glm::vec3> targets(rays);
+    for (glm::vec3 &target : targets)
+    {
+        float r = 30.0f + 60.0f * unit(rng), angle = 6.2831853f * unit(rng);
+        target = glm::vec3(r * std::sin(angle), 0.0f, r * std::cos(angle));
+    }
+    glm::vec3 camera(0.0f, 60.0f, 120.0f);
+    int hits = 0;
+    timer.Reset();
+    for (const glm::vec3 &target : targets)
+    {
+        RayHit hit{};
+        hits += bvh.Raycast(camera, target - camera, hit);
+    }
+    double query = timer.Seconds() / rays;
+
+    int mismatches = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        glm::vec3 direction = glm::normalize(targets[i] - camera);
+        RayHit a{}, b{};
+        bool ha = bvh.Raycast(camera, direction, a), hb = BruteForce(bodies, camera, direction, b);
+        if (ha != hb || (ha && a.body != b.body))
+            ++mismatches;
+    }
+
+    std::printf("%zu bodies, %zu nodes\n", n, bvh.getNodeCount());
+    std::printf("build %.2f ms, full refit %.3f ms, refit of %zu moved %.1f us\n",
+                build * 1e3, refit * 1e3, movedCount, partial * 1e6);
+    std::printf("raycast %.2f us, %d of %d rays hit, %d mismatches against brute force\n",
+                query * 1e6, hits, rays, mismatches);
+    return 0;
+}
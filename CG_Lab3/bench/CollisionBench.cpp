@@ -0,0 +1,101 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/Collision.h"
+#include "../src/NBody.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+// n spheres of radius 0.1 to 0.5 drifting in a cube sized for a few contacts per sphere
+static void MakeBox(Bodies &bodies, size_t n)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float side = 3.0f * std::cbrt(float(n));
+
+    bodies.Clear();
+    for (size_t i = 0; i < n; ++i)
+        bodies.Add(glm::vec3(side * unit(rng), side * unit(rng), side * unit(rng)),
+                   glm::vec3(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f) * 4.0f,
+                   1e-3f, 0.1f + 0.4f * unit(rng));
+}
+
+// the GPU belt layout: a thin disk that overlaps a lot along any sweep axis, plus a large Sun
+static void MakeBelt(Bodies &bodies, size_t n)
+{
+    bodies.Clear();
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), 8000.0f, 5.0f);
+    AddBelt(bodies, 0, n - 1, 6.0f, 200.0f);
+}
+
+static void Drift(Bodies &bodies, float dt)
+{
+    for (size_t i = 0; i < bodies.Size(); ++i)
+    {
+        bodies.x[i] += bodies.vx[i] * dt;
+        bodies.y[i] += bodies.vy[i] * dt;
+        bodies.z[i] += bodies.vz[i] * dt;
+    }
+}
+
+// collision [spheres] [box|belt] [frames]
+int BenchCollision(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 100000;
+    std::string scene = args.size() > 1 ? args[1] : "box";
+    int frames = args.size() > 2 ? std::stoi(args[2]) : 10;
+
+    Bodies initial;
+    if (scene == "belt")
+        MakeBelt(initial, n);
+    else
+        MakeBox(initial, n);
+
+    std::printf("%zu spheres, %s scene, mean over %d moving frames\n", n, scene.c_str(), frames);
+    std::printf("%8s %16s %12s %10s %10s %10s %10s %10s\n",
+                "threads", "broadphase", "candidates", "contacts", "build ms", "pairs ms", "narrow ms", "total ms");
+
+    std::vector<Contact> reference;
+    for (Broadphase broadphase : { Broadphase::SWEEP, Broadphase::HASH, Broadphase::AUTO })
+        for (unsigned threads : ThreadCounts())
+        {
+            ThreadPool pool(threads);
+            Collision collision(pool, broadphase);
+            Bodies bodies = initial;
+            Collision::Stats sum{};
+            for (int f = 0; f < frames; ++f)
+            {
+                Drift(bodies, 1.0f / 60.0f);
+                collision.Detect(bodies);
+                const Collision::Stats &stats = collision.getStats();
+                sum.broadphase = stats.broadphase;
+                sum.candidates += stats.candidates;
+                sum.contacts += stats.contacts;
+                sum.buildMs += stats.buildMs;
+                sum.pairMs += stats.pairMs;
+                sum.narrowMs += stats.narrowMs;
+            }
+
+            // both broadphases must agree on the contacts of the last frame
+            std::vector<Contact> contacts = collision.getContacts();
+            std::sort(contacts.begin(), contacts.end(), [](const Contact &l, const Contact &r) {
+                return l.a != r.a ? l.a < r.a : l.b < r.b;
+            });
+            bool match = true;
+            if (reference.empty())
+                reference = contacts;
+            else
+                match = contacts.size() == reference.size() && std::equal(contacts.begin(), contacts.end(), reference.begin(),
+                        [](const Contact &l, const Contact &r) { return l.a == r.a && l.b == r.b; });
+
+            std::printf("%8u %16s %12zu %10zu %10.2f %10.2f %10.2f %10.2f%s\n", threads, BroadphaseName(sum.broadphase),
+                        sum.candidates / frames, sum.contacts / frames, sum.buildMs / frames, sum.pairMs / frames,
+                        sum.narrowMs / frames, (sum.buildMs + sum.pairMs + sum.narrowMs) / frames,
+                        match ? "" : "  contacts differ");
+        }
+    return 0;
+}
@@ -0,0 +1,61 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/DirectSum.h"
+
+#include <cmath>
+#include <cstdio>
+
+static double Measure(DirectSum &direct, Bodies &bodies, DirectSum::Path path)
+{
+    direct.ComputeAccelerations(bodies, path);
+    int repeats = 0;
+    Timer timer;
+    do {
+        direct.ComputeAccelerations(bodies, path);
+        ++repeats;
+    } while (timer.Seconds() < 0.25);
+    return timer.Seconds() / repeats;
+}
+
+// direct-sum [max bodies]
+int BenchDirectSum(const std::vector<std::string> &args)
+{
+    size_t maxBodies = args.size() > 0 ? std::stoul(args[0]) : 16384;
+    if (!DirectSum::HasAVX2())
+        std::printf("AVX2/FMA not available, the vector column runs the scalar path\n");
+
+    std::printf("%8s %8s %14s %14s %9s %11s\n", "bodies", "threads", "scalar Gint/s", "AVX2 Gint/s", "speedup", "max rel err");
+    for (size_t n = 256; n <= maxBodies; n *= 4)
+    {
+        Bodies bodies;
+        MakeDisk(bodies, n);
+
+        for (unsigned threads : ThreadCounts())
+        {
+            ThreadPool pool(threads);
+            DirectSum direct(pool);
+
+            double scalar = Measure(direct, bodies, DirectSum::Path::SCALAR);
+            std::vector<float> ax = bodies.ax, ay = bodies.ay, az = bodies.az;
+            double avx = Measure(direct, bodies, DirectSum::Path::AVX2);
+
+            // rsqrt plus one Newton step has to stay close to the exact reference
+            double err = 0.0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                double ref = std::sqrt(double(ax[i])*ax[i] + double(ay[i])*ay[i] + double(az[i])*az[i]);
+                double dx = bodies.ax[i] - ax[i], dy = bodies.ay[i] - ay[i], dz = bodies.az[i] - az[i];
+                if (ref > 0.0)
+                    err = std::max(err, std::sqrt(dx*dx + dy*dy + dz*dz) / ref);
+            }
+
+            double interactions = double(n) * double(n);
+            std::printf("%8zu %8u %14.3f %14.3f %8.2fx %11.2e\n", n, threads,
+                        interactions / scalar * 1e-9, interactions / avx * 1e-9, scalar / avx, err);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/Ephemeris.h"
+#include "../src/KeplerOrbits.h"
+#include "../src/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// random times across the table, so every call pays for the segment search
+static double Measure(const Ephemeris &ephemeris, const std::vector<double> &times,
+                      std::vector<float> &x, std::vector<float> &y, std::vector<float> &z, Ephemeris::Path path)
+{
+    size_t repeats = 0;
+    Timer timer;
+    do {
+        ephemeris.Evaluate(times[repeats % times.size()], x.data(), y.data(), z.data(), path);
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    return timer.Seconds() / double(repeats);
+}
+
+// ephemeris [bodies] [segments] [coefficients] [file]
+int BenchEphemeris(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 4096;
+    size_t segments = args.size() > 1 ? std::stoul(args[1]) : 256;
+    size_t coefficients = args.size() > 2 ? std::stoul(args[2]) : 12;
+    std::string path = args.size() > 3 ? args[3] : "ephemeris.bin";
+    // the fastest orbit (a = 20) turns by half a radian per segment
+    const double segmentLength = 0.5;
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    KeplerOrbits orbits(8000.0f);
+    for (size_t i = 0; i < n; ++i)
+    {
+        OrbitalElements elements{};
+        elements.semiMajorAxis = 20.0f + 80.0f * unit(rng);
+        elements.eccentricity = 0.3f * unit(rng);
+        elements.inclination = 0.2f * unit(rng);
+        elements.ascendingNode = 6.2831853f * unit(rng);
+        elements.periapsis = 6.2831853f * unit(rng);
+        elements.meanAnomaly = 6.2831853f * unit(rng);
+        orbits.Add(elements);
+    }
+
+    double end = segmentLength * double(segments);
+    Timer timer;
+    bool written = Ephemeris::Fit(path, n, coefficients, 0.0, end, segments, orbits.Key(),
+                                  [&orbits](double t, float *x, float *y, float *z) {
+                                      orbits.Propagate(t, x, y, z, KeplerOrbits::Path::SCALAR);
+                                  });
+    double fit = timer.Seconds();
+    if (!written)
+        return 1;
+
+    timer.Reset();
+    Ephemeris ephemeris;
+    if (!ephemeris.Open(path))
+        return 1;
+    double open = timer.Seconds();
+
+    std::vector<double> times(4096);
+    for (double &t : times)
+        t = end * unit(rng);
+
+    std::vector<float> x(n), y(n), z(n), rx(n), ry(n), rz(n);
+    double scalar = Measure(ephemeris, times, rx, ry, rz, Ephemeris::Path::SCALAR);
+    double avx = Measure(ephemeris, times, x, y, z, Ephemeris::Path::AVX2);
+
+    // the analytic orbits the table was fitted to, for reference
+    size_t repeats = 0;
+    timer.Reset();
+    do {
+        orbits.Propagate(times[repeats % times.size()], rx.data(), ry.data(), rz.data());
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    double kepler = timer.Seconds() / double(repeats);
+
+    // fit error against the converged Kepler solution between the nodes
+    double err = 0.0;
+    for (size_t k = 0; k < 64; ++k)
+    {
+        double t = times[k];
+        ephemeris.Evaluate(t, x.data(), y.data(), z.data());
+        orbits.Propagate(t, rx.data(), ry.data(), rz.data(), KeplerOrbits::Path::SCALAR);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double d = std::sqrt(std::pow(x[i] - rx[i], 2) + std::pow(y[i] - ry[i], 2) + std::pow(z[i] - rz[i], 2));
+            double r = std::sqrt(double(rx[i])*rx[i] + double(ry[i])*ry[i] + double(rz[i])*rz[i]);
+            err = std::max(err, d / r);
+        }
+    }
+
+    std::printf("%zu bodies, %zu segments of %.2f s, %zu coefficients, %.1f MB, AVX2 %s\n", n, segments,
+                segmentLength, coefficients, double(n) * segments * coefficients * 12.0 / 1048576.0,
+                CpuHasAVX2() ? "on" : "off (scalar fallback)");
+    std::printf("fit and write %.2f s, open %.3f ms\n", fit, open * 1e3);
+    std::printf("%8s %12s %16s\n", "path", "us / batch", "Mevals / s");
+    std::printf("%8s %12.2f %16.2f\n", "scalar", scalar * 1e6, n / scalar * 1e-6);
+    std::printf("%8s %12.2f %16.2f\n", "AVX2", avx * 1e6, n / avx * 1e-6);
+    std::printf("%8s %12.2f %16.2f\n", "kepler", kepler * 1e6, n / kepler * 1e-6);
+    std::printf("speedup %.2fx, max relative position error %.2e\n", scalar / avx, err);
+    return 0;
+}
@@ -0,0 +1,71 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/Integrator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Sun with planets on slightly eccentric, slightly inclined orbits; heavy enough to perturb each other
+static void MakePlanets(Bodies &bodies, size_t planets)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float sunMass = 8000.0f;
+
+    bodies.Clear();
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), sunMass, 5.0f);
+    for (size_t i = 0; i < planets; ++i)
+    {
+        float r = 20.0f * std::pow(1.15f, float(i));
+        float angle = 6.2831853f * unit(rng);
+        // 0.9 to 1.1 of the circular speed gives eccentricities up to about 0.2
+        float v = std::sqrt(GRAVITY * sunMass / r) * (0.9f + 0.2f * unit(rng));
+        float tilt = 0.05f * (unit(rng) - 0.5f);
+        bodies.Add(glm::vec3(r * std::cos(angle), r * tilt, r * std::sin(angle)),
+                   glm::vec3(-v * std::sin(angle), 0.0f, v * std::cos(angle)),
+                   1.0f, 0.5f);
+    }
+}
+
+// integrators [planets] [frames]
+int BenchIntegrators(const std::vector<std::string> &args)
+{
+    size_t planets = args.size() > 0 ? std::stoul(args[0]) : 8;
+    int frames = args.size() > 1 ? std::stoi(args[1]) : 600;
+    const float frame = 1.0f / 60.0f;
+
+    std::printf("%zu planets, %d frames of %.4f s\n", planets, frames, frame);
+    std::printf("%20s %8s %12s %10s %14s %12s\n", "integrator", "warp", "sim time", "substeps", "substeps / s", "max |dE/E|");
+    for (IntegratorType type : { IntegratorType::EULER, IntegratorType::LEAPFROG, IntegratorType::WISDOM_HOLMAN })
+    {
+        for (float warp : { 1.0f, 10.0f, 100.0f, 1000.0f })
+        {
+            ThreadPool pool(1);
+            NBody nbody(pool);
+            nbody.setKernel(GravityKernel::DIRECT_SCALAR);
+            MakePlanets(nbody.getBodies(), planets);
+            Integrator integrator(nbody, type);
+            integrator.setWarp(warp);
+
+            double energy = TotalEnergy(nbody.getBodies());
+            double drift = 0.0, simulated = 0.0;
+            long substeps = 0;
+            double wall = 0.0;
+            for (int f = 0; f < frames; ++f)
+            {
+                Timer timer;
+                simulated += integrator.Advance(frame);
+                wall += timer.Seconds();
+                substeps += integrator.getLastSubsteps();
+                drift = std::max(drift, std::fabs((TotalEnergy(nbody.getBodies()) - energy) / energy));
+            }
+            std::printf("%20s %8.0f %12.1f %10ld %14.0f %12.2e\n", IntegratorName(type), warp, simulated,
+                        substeps, substeps / wall, drift);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/KeplerOrbits.h"
+#include "../src/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+static double Measure(const KeplerOrbits &orbits, std::vector<float> &x, std::vector<float> &y, std::vector<float> &z,
+                      KeplerOrbits::Path path)
+{
+    int repeats = 0;
+    double t = 0.0;
+    Timer timer;
+    do {
+        orbits.Propagate(t, x.data(), y.data(), z.data(), path);
+        t += 1.0 / 60.0;
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    return timer.Seconds() / repeats;
+}
+
+// scattered orbits, each at its own time, as a staggered update asks for them
+static double MeasureGather(const KeplerOrbits &orbits, const std::vector<uint32_t> &indices, std::vector<double> &times,
+                            std::vector<float> (&out)[6], KeplerOrbits::Path path)
+{
+    int repeats = 0;
+    Timer timer;
+    do {
+        orbits.Propagate(indices.data(), times.data(), indices.size(), out[0].data(), out[1].data(), out[2].data(),
+                         out[3].data(), out[4].data(), out[5].data(), path);
+        for (double &t : times)
+            t += 1.0 / 60.0;
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    return timer.Seconds() / repeats;
+}
+
+// kepler [orbits] [max eccentricity]
+int BenchKepler(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 1000000;
+    float maxE = args.size() > 1 ? std::stof(args[1]) : 0.9f;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    KeplerOrbits orbits(8000.0f);
+    for (size_t i = 0; i < n; ++i)
+    {
+        OrbitalElements elements{};
+        elements.semiMajorAxis = 20.0f + 80.0f * unit(rng);
+        elements.eccentricity = maxE * unit(rng);
+        elements.inclination = 0.2f * unit(rng);
+        elements.ascendingNode = 6.2831853f * unit(rng);
+        elements.periapsis = 6.2831853f * unit(rng);
+        elements.meanAnomaly = 6.2831853f * unit(rng);
+        orbits.Add(elements);
+    }
+
+    std::vector<float> x(n), y(n), z(n), rx(n), ry(n), rz(n);
+    double scalar = Measure(orbits, rx, ry, rz, KeplerOrbits::Path::SCALAR);
+    double avx = Measure(orbits, x, y, z, KeplerOrbits::Path::AVX2);
+
+    // accuracy of the fixed iteration count against the converged reference, at a late time
+    double t = 12345.678;
+    orbits.Propagate(t, rx.data(), ry.data(), rz.data(), KeplerOrbits::Path::SCALAR);
+    orbits.Propagate(t, x.data(), y.data(), z.data(), KeplerOrbits::Path::AVX2);
+    double err = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        double d = std::sqrt(std::pow(x[i] - rx[i], 2) + std::pow(y[i] - ry[i], 2) + std::pow(z[i] - rz[i], 2));
+        double r = std::sqrt(double(rx[i])*rx[i] + double(ry[i])*ry[i] + double(rz[i])*rz[i]);
+        err = std::max(err, d / r);
+    }
+
+    // every orbit once in random order, at times up to a few frames apart
+    std::vector<uint32_t> indices(n);
+    std::vector<double> times(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        indices[i] = uint32_t(i);
+        times[i] = t + 0.1 * unit(rng);
+    }
+    std::shuffle(indices.begin(), indices.end(), rng);
+    std::vector<float> gathered[6], reference[6];
+    for (int c = 0; c < 6; ++c)
+    {
+        gathered[c].resize(n);
+        reference[c].resize(n);
+    }
+    std::vector<double> start = times;
+    double gatherScalar = MeasureGather(orbits, indices, times, reference, KeplerOrbits::Path::SCALAR);
+    times = start;
+    double gatherAvx = MeasureGather(orbits, indices, times, gathered, KeplerOrbits::Path::AVX2);
+    times = start;
+    for (std::vector<float> (*out)[6] : { &reference, &gathered })
+        orbits.Propagate(indices.data(), times.data(), n, (*out)[0].data(), (*out)[1].data(), (*out)[2].data(),
+                         (*out)[3].data(), (*out)[4].data(), (*out)[5].data(),
+                         out == &reference ? KeplerOrbits::Path::SCALAR : KeplerOrbits::Path::AVX2);
+    double gatherErr = 0.0, velocityErr = 0.0;
+    for (size_t k = 0; k < n; ++k)
+    {
+        double errors[2];
+        for (int v = 0; v < 2; ++v)
+        {
+            double d = 0.0, r = 0.0;
+            for (int c = 3 * v; c < 3 * v + 3; ++c)
+            {
+                d += std::pow(gathered[c][k] - reference[c][k], 2);
+                r += double(reference[c][k]) * reference[c][k];
+            }
+            errors[v] = std::sqrt(d / r);
+        }
+        gatherErr = std::max(gatherErr, errors[0]);
+        velocityErr = std::max(velocityErr, errors[1]);
+    }
+
+    std::printf("%zu orbits, e < %.2f, AVX2 %s\n", n, maxE, CpuHasAVX2() ? "on" : "off (scalar fallback)");
+    std::printf("%14s %12s %16s\n", "path", "ms / batch", "Mevals / s");
+    std::printf("%14s %12.3f %16.2f\n", "scalar", scalar * 1e3, n / scalar * 1e-6);
+    std::printf("%14s %12.3f %16.2f\n", "AVX2", avx * 1e3, n / avx * 1e-6);
+    std::printf("%14s %12.3f %16.2f\n", "gather scalar", gatherScalar * 1e3, n / gatherScalar * 1e-6);
+    std::printf("%14s %12.3f %16.2f\n", "gather AVX2", gatherAvx * 1e3, n / gatherAvx * 1e-6);
+    std::printf("speedup %.2fx, max relative position error %.2e\n", scalar / avx, err);
+    std::printf("gathered speedup %.2fx, max relative position error %.2e, velocity %.2e\n",
+                gatherScalar / gatherAvx, gatherErr, velocityErr);
+    return 0;
+}
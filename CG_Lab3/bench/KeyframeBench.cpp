@@ -0,0 +1,142 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/Integrator.h"
+#include "../src/KeyframeCache.h"
+#include "../src/KeplerOrbits.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// of every period of keyframe intervals the last few are left out of the recording, e.g. while
+// scrubbing; the hole is wider than the cache looks for neighbours, so scrubbing into it misses
+#define KEYFRAME_HOLE_PERIOD 16
+#define KEYFRAME_HOLE_LENGTH 6
+// reconstructions integrate the whole system, only this many of them are timed
+#define KEYFRAME_RECONSTRUCTIONS 8
+
+// exact states of all orbits at time t, the central body at index 0 stays at the origin
+static void Exact(const KeplerOrbits &orbits, double t, Bodies &bodies)
+{
+    for (size_t i = 0; i < orbits.Size(); ++i)
+    {
+        glm::vec3 position, velocity;
+        orbits.State(i, t, position, velocity);
+        bodies.x[i + 1] = position.x;
+        bodies.y[i + 1] = position.y;
+        bodies.z[i + 1] = position.z;
+        bodies.vx[i + 1] = velocity.x;
+        bodies.vy[i + 1] = velocity.y;
+        bodies.vz[i + 1] = velocity.z;
+    }
+}
+
+// keyframes [bodies] [recorded seconds] [cap MB]
+int BenchKeyframes(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 2000;
+    double span = args.size() > 1 ? std::stod(args[1]) : 600.0;
+    size_t cap = (args.size() > 2 ? std::stoul(args[2]) : 32) << 20;
+    const double interval = 0.5, frame = 1.0 / 60.0;
+
+    // Kepler orbits of light bodies around a heavy one stand in for the integrator,
+    // they give the exact state at any time
+    const float centralMass = 8000.0f;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    KeplerOrbits orbits(centralMass);
+    Bodies bodies, shown;
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), centralMass, 5.0f);
+    shown.Add(glm::vec3(0.0f), glm::vec3(0.0f), centralMass, 5.0f);
+    for (size_t i = 0; i < n; ++i)
+    {
+        orbits.Add({ 20.0f + 80.0f * unit(rng), 0.3f * unit(rng), 0.2f * unit(rng),
+                     6.2831853f * unit(rng), 6.2831853f * unit(rng), 6.2831853f * unit(rng) });
+        bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), 1e-6f, 0.1f);
+        shown.Add(glm::vec3(0.0f), glm::vec3(0.0f), 1e-6f, 0.1f);
+    }
+
+    // every frame of the recording run offers its state, one in every 30 is kept;
+    // some intervals are not recorded at all so that scrubbing into them has to reconstruct
+    KeyframeCache cache(interval, 64, cap);
+    Timer timer;
+    double recordTime = 0.0;
+    size_t frames = 0;
+    for (double t = 0.0, computed = -1.0; t < span; t += frame)
+    {
+        if (int64_t(std::floor(t / interval)) % KEYFRAME_HOLE_PERIOD >= KEYFRAME_HOLE_PERIOD - KEYFRAME_HOLE_LENGTH)
+            continue;
+        // only the frames starting an interval need the real state, the others are refused anyway
+        if (std::floor(t / interval) != std::floor(computed / interval)) {
+            Exact(orbits, t, bodies);
+            computed = t;
+        }
+        timer.Reset();
+        cache.Record(t, bodies);
+        recordTime += timer.Seconds();
+        ++frames;
+    }
+
+    // the reconstruction main does: the nearest keyframe before, integrated onwards
+    ThreadPool pool;
+    NBody nbody(pool);
+    nbody.getBodies() = shown;
+    Integrator integrator(nbody);
+    integrator.setWarp(1.0f);
+
+    // scrubbing to random times of the recording, mostly in the part still cached
+    double cached = double(cache.getStats().keyframes) * interval * KEYFRAME_HOLE_PERIOD /
+                    (KEYFRAME_HOLE_PERIOD - KEYFRAME_HOLE_LENGTH);
+    std::uniform_real_distribution<double> when(std::max(0.0, span - 1.25 * cached), span - interval);
+    const int scrubs = 2000;
+    double scrubTime = 0.0, reconstructTime = 0.0, reconstructSpan = 0.0;
+    long substeps = 0;
+    float error = 0.0f, reconstructError = 0.0f;
+    int reconstructed = 0, uncached = 0;
+    for (int k = 0; k < scrubs; ++k)
+    {
+        double t = when(rng);
+        timer.Reset();
+        bool hit = cache.Interpolate(t, shown);
+        scrubTime += timer.Seconds();
+        Bodies *state = &shown;
+        if (!hit) {
+            double keyTime;
+            timer.Reset();
+            if (!cache.Nearest(t, nbody.getBodies(), keyTime)) {
+                ++uncached;
+                continue;
+            }
+            if (reconstructed == KEYFRAME_RECONSTRUCTIONS)
+                continue;
+            integrator.Advance(float(t - keyTime));
+            reconstructTime += timer.Seconds();
+            reconstructSpan += t - keyTime;
+            substeps += integrator.getLastSubsteps();
+            ++reconstructed;
+            state = &nbody.getBodies();
+        }
+        Exact(orbits, t, bodies);
+        float &worst = hit ? error : reconstructError;
+        for (size_t i = 1; i <= n; ++i)
+            worst = std::max(worst, glm::length(bodies.Position(i) - state->Position(i)));
+    }
+
+    const KeyframeCache::Stats &stats = cache.getStats();
+    std::printf("%zu bodies, %.0f s recorded at %.0f fps, a keyframe every %.1f s, cap %zu MB\n",
+                n, span, 1.0 / frame, interval, cap >> 20);
+    std::printf("cache: %zu segments, %.1f MB, %zu keyframes, %zu evictions\n",
+                stats.segments, double(stats.bytes) / (1 << 20), stats.keyframes, stats.evictions);
+    std::printf("record %.2f us per frame\n", recordTime / frames * 1e6);
+    std::printf("scrub %.1f us, %zu hits, %zu misses, %d of them before the oldest keyframe\n",
+                scrubTime / scrubs * 1e6, stats.hits, stats.misses, uncached);
+    if (reconstructed > 0)
+        std::printf("reconstruct %.2f ms from the nearest keyframe, %.2f s and %ld substeps back on average, %d timed\n",
+                    reconstructTime / reconstructed * 1e3, reconstructSpan / reconstructed,
+                    substeps / reconstructed, reconstructed);
+    std::printf("max position error: Hermite %.5f, reconstructed %.5f\n", error, reconstructError);
+    return 0;
+}
@@ -0,0 +1,116 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/LooseOctree.h"
+#include "../src/NBody.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+static void PrintStats(const char *name, const LooseOctree::Stats &stats)
+{
+    double queries = double(std::max<size_t>(stats.queries, 1));
+    std::printf("%10s %10zu %12.1f %12.1f %12.1f %12.2f\n", name, stats.queries, stats.nodesVisited / queries,
+                stats.itemsTested / queries, stats.itemsFound / queries, stats.ms * 1e3 / queries);
+}
+
+// octree [bodies] [queries]
+int BenchOctree(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 300000;
+    int queries = args.size() > 1 ? std::stoi(args[1]) : 1000;
+
+    Bodies bodies;
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), 8000.0f, 5.0f);
+    AddBelt(bodies, 0, n - 1, 30.0f, 300.0f);
+
+    LooseOctree octree(glm::vec3(0.0f), 512.0f);
+    Timer timer;
+    for (size_t i = 0; i < n; ++i)
+        octree.Insert(uint32_t(i), bodies.Position(i), bodies.radius[i]);
+    double insert = timer.Seconds();
+
+    // one frame of orbital motion for everything
+    const float dt = 1.0f / 60.0f;
+    for (size_t i = 0; i < n; ++i)
+    {
+        bodies.x[i] += bodies.vx[i] * dt;
+        bodies.y[i] += bodies.vy[i] * dt;
+        bodies.z[i] += bodies.vz[i] * dt;
+    }
+    timer.Reset();
+    for (size_t i = 0; i < n; ++i)
+        octree.Move(uint32_t(i), bodies.Position(i), bodies.radius[i]);
+    double move = timer.Seconds();
+
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> pick(1, uint32_t(n - 1));
+
+    // remove and reinsert a tenth of the belt
+    timer.Reset();
+    std::vector<uint32_t> churn(n / 10);
+    for (uint32_t &id : churn)
+    {
+        id = pick(rng);
+        octree.Remove(id);
+    }
+    for (uint32_t id : churn)
+        octree.Insert(id, bodies.Position(id), bodies.radius[id]);
+    double reinsert = timer.Seconds() / double(2 * churn.size());
+
+    // brute force reference for a few queries
+    int mismatches = 0;
+    std::vector<uint32_t> found;
+    for (int q = 0; q < queries; ++q)
+    {
+        uint32_t target = pick(rng);
+        glm::vec3 centre = bodies.Position(target);
+        found.clear();
+        octree.QuerySphere(centre, 2.0f, found);
+        uint32_t nearest;
+        float distance;
+        octree.Nearest(centre, nearest, distance, target);
+
+        if (q < 20) {
+            size_t count = 0;
+            float best = INFINITY;
+            for (size_t i = 0; i < n; ++i)
+            {
+                float d = glm::length(bodies.Position(i) - centre);
+                if (d <= 2.0f + bodies.radius[i])
+                    ++count;
+                if (i != target)
+                    best = std::min(best, std::max(d - bodies.radius[i], 0.0f));
+            }
+            if (count != found.size() || std::fabs(best - distance) > 1e-4f)
+                ++mismatches;
+        }
+    }
+
+    // cameras orbiting above the belt
+    for (int q = 0; q < queries / 10; ++q)
+    {
+        float angle = 6.2831853f * unit(rng);
+        glm::vec3 eye(350.0f * std::sin(angle), 80.0f, 350.0f * std::cos(angle));
+        glm::mat4 clip = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 400.0f)
+                       * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        found.clear();
+        octree.QueryFrustum(Frustum(clip), found);
+    }
+
+    std::printf("%zu bodies, %zu nodes in a pool of %zu\n", n, octree.getNodeCount(), octree.getNodeCapacity());
+    std::printf("insert %.1f ns, move %.1f ns, remove or reinsert %.1f ns per body\n",
+                insert / n * 1e9, move / n * 1e9, reinsert * 1e9);
+    std::printf("%10s %10s %12s %12s %12s %12s\n", "query", "count", "nodes", "tested", "found", "us");
+    PrintStats("sphere", octree.getStats(OctreeQuery::SPHERE));
+    PrintStats("nearest", octree.getStats(OctreeQuery::NEAREST));
+    PrintStats("frustum", octree.getStats(OctreeQuery::FRUSTUM));
+    std::printf("%d mismatches against brute force\n", mismatches);
+    return 0;
+}
@@ -0,0 +1,105 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/TrajectoryPredictor.h"
+#include "../src/NBody.h"
+
+#include <cstdio>
+#include <random>
+#include <thread>
+
+// waits until the state of the given time is published and returns it
+static const Polylines &WaitForPublish(TrajectoryPredictor &predictor, double time)
+{
+    while (!predictor.Acquire() || predictor.getPolylines().time != time)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    return predictor.getPolylines();
+}
+
+// moves every body onto its first predicted sample, which is exactly one step ahead
+static void FollowPrediction(Bodies &bodies, const Polylines &polylines)
+{
+    for (size_t i = 0; i < bodies.Size(); ++i)
+    {
+        const float *p = &polylines.vertices[3 * (polylines.first[i] + 1)];
+        bodies.x[i] = p[0];
+        bodies.y[i] = p[1];
+        bodies.z[i] = p[2];
+    }
+}
+
+// predictor [bodies] [invalidated per update] [threads]
+int BenchPredictor(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 2000;
+    size_t invalidated = args.size() > 1 ? std::stoul(args[1]) : 16;
+    unsigned threads = args.size() > 2 ? unsigned(std::stoul(args[2])) : 0;
+    const double horizon = 12.0, step = 0.02;
+
+    Bodies bodies;
+    bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), 8000.0f, 5.0f);
+    AddBelt(bodies, 0, n - 1, 30.0f, 90.0f);
+    TrajectoryPredictor predictor(horizon, step, threads);
+
+    // the render side only copies, however busy the worker is
+    Timer timer;
+    double worstSubmit = 0.0;
+    int submits = 0;
+    do {
+        Timer one;
+        predictor.Submit(bodies, 0.0);
+        worstSubmit = std::max(worstSubmit, one.Seconds());
+        ++submits;
+    } while (timer.Seconds() < 0.5);
+    double submit = timer.Seconds() / submits;
+
+    // a time before the grid forces a full prediction
+    double time = -1.0;
+    predictor.Submit(bodies, time);
+    const Polylines &full = WaitForPublish(predictor, time);
+    double fullMs = full.workMs;
+    size_t fullRestarts = full.restarted, vertices = full.vertices.size() / 3;
+
+    // bodies exactly on their paths: only the new samples at the far end are integrated
+    double extendMs = 0.0;
+    size_t extendRestarts = 0;
+    const int updates = 20;
+    const Polylines *polylines = &full;
+    for (int u = 0; u < updates; ++u)
+    {
+        FollowPrediction(bodies, *polylines);
+        time += step;
+        predictor.Submit(bodies, time);
+        polylines = &WaitForPublish(predictor, time);
+        extendMs += polylines->workMs;
+        extendRestarts += polylines->restarted;
+    }
+
+    // a few light bodies changed by something the prediction cannot know about
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> pick(1, n - 1);
+    double restartMs = 0.0;
+    size_t restarts = 0;
+    for (int u = 0; u < updates; ++u)
+    {
+        FollowPrediction(bodies, *polylines);
+        for (size_t k = 0; k < invalidated; ++k)
+            predictor.Invalidate(pick(rng));
+        time += step;
+        predictor.Submit(bodies, time);
+        polylines = &WaitForPublish(predictor, time);
+        restartMs += polylines->workMs;
+        restarts += polylines->restarted;
+    }
+
+    std::printf("%zu bodies, %.0f s horizon, %zu samples per body, %zu vertices\n",
+                n, horizon, size_t(horizon / step), vertices);
+    std::printf("submit %.1f us mean, %.1f us worst over %d calls\n", submit * 1e6, worstSubmit * 1e6, submits);
+    std::printf("%-24s %10s %10s\n", "update", "ms", "restarted");
+    std::printf("%-24s %10.2f %10zu\n", "full", fullMs, fullRestarts);
+    std::printf("%-24s %10.2f %10.1f\n", "extend", extendMs / updates, double(extendRestarts) / updates);
+    std::printf("%-24s %10.2f %10.1f\n", "extend + invalidated", restartMs / updates, double(restarts) / updates);
+    return 0;
+}
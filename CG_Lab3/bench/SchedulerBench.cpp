@@ -0,0 +1,139 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/KeplerOrbits.h"
+#include "../src/Scheduler.h"
+#include "../src/Clock.h"
+#include "../src/StaggeredUpdate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// orbits from 20 to 2000 units, evenly spread over the distance levels
+static void MakeOrbits(KeplerOrbits &orbits, size_t n)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (size_t i = 0; i < n; ++i)
+    {
+        OrbitalElements elements{};
+        elements.semiMajorAxis = 20.0f * std::pow(100.0f, unit(rng));
+        elements.eccentricity = 0.3f * unit(rng);
+        elements.inclination = 0.2f * unit(rng);
+        elements.ascendingNode = 6.2831853f * unit(rng);
+        elements.periapsis = 6.2831853f * unit(rng);
+        elements.meanAnomaly = 6.2831853f * unit(rng);
+        orbits.Add(elements);
+    }
+}
+
+// due orbits solved together between two looks at the clock, as in main
+#define SCHEDULER_BATCH 64
+// a mean orbit system time this far over the budget fails the run
+#define SCHEDULER_BUDGET_SLACK 1.1
+
+// scheduler [max orbits] [levels] [orbit budget ms]
+int BenchScheduler(const std::vector<std::string> &args)
+{
+    size_t maxCount = args.size() > 0 ? std::stoul(args[0]) : 64000;
+    int levels = args.size() > 1 ? std::stoi(args[1]) : 5;
+    double budgetMs = args.size() > 2 ? std::stod(args[2]) : 1.0;
+    const int frames = 240;
+    const float dt = 1.0f / 60.0f;
+
+    std::printf("%d frames of %.1f ms, %d levels, orbit budget %.2f ms\n", frames, dt * 1e3, levels, budgetMs);
+    std::printf("%8s %12s %14s %10s %10s %6s %14s %12s\n",
+                "orbits", "full ms", "staggered ms", "per frame", "carried", "bias", "max rel error", "deferred");
+    bool over = false;
+    for (size_t n = 1000; n <= maxCount; n *= 4)
+    {
+        KeplerOrbits orbits(8000.0f);
+        MakeOrbits(orbits, n);
+        std::vector<glm::vec3> exact(n), shown(n);
+        std::vector<float> x(n), y(n), z(n);
+
+        // every orbit on every frame, one batch at a single time
+        double time = 0.0;
+        Timer timer;
+        for (int f = 0; f < frames; ++f)
+        {
+            time += dt;
+            orbits.Propagate(time, x.data(), y.data(), z.data());
+        }
+        double full = timer.Seconds() / frames;
+
+        // the same work as a scheduled system next to a cheap one at a lower rate
+        StaggeredUpdate staggered(levels, 40.0f);
+        staggered.Resize(n);
+        Scheduler scheduler(4.0);
+        size_t updated = 0, carried = 0;
+        time = 0.0;
+        size_t orbitSystem = scheduler.Add("orbits", 0.0f, budgetMs, [&](float) {
+            auto start = std::chrono::steady_clock::now();
+            const std::vector<uint32_t> &due = staggered.Due(scheduler.getFrame(), [&](uint32_t i) {
+                return glm::length(shown[i]);
+            });
+            size_t done = 0;
+            while (done < due.size())
+            {
+                if (done > 0 && Milliseconds(start) > budgetMs)
+                    break;
+                const uint32_t *batch = &due[done];
+                size_t count = std::min(due.size() - done, size_t(SCHEDULER_BATCH));
+                double target[SCHEDULER_BATCH];
+                float px[SCHEDULER_BATCH], py[SCHEDULER_BATCH], pz[SCHEDULER_BATCH];
+                float vx[SCHEDULER_BATCH], vy[SCHEDULER_BATCH], vz[SCHEDULER_BATCH];
+                for (size_t k = 0; k < count; ++k)
+                    target[k] = time + double(staggered.Frames(batch[k]) - 1) * dt;
+                orbits.Propagate(batch, target, count, px, py, pz, vx, vy, vz);
+                for (size_t k = 0; k < count; ++k)
+                {
+                    staggered.SetKey(batch[k], time, glm::vec3(px[k], py[k], pz[k]), target[k]);
+                    shown[batch[k]] = staggered.At(batch[k], time);
+                }
+                done += count;
+            }
+            staggered.Carry(done);
+            double keyed = Milliseconds(start);
+            staggered.Adapt(keyed, budgetMs);
+            staggered.Interpolate(time, budgetMs - keyed, SIZE_MAX, [&](uint32_t i, const glm::vec3 &at) { shown[i] = at; });
+            updated += done;
+            carried += staggered.getCarried();
+        });
+        glm::vec3 centroid(0.0f);
+        size_t statsSystem = scheduler.Add("centroid", 4.0f, 0.5, [&](float) {
+            centroid = glm::vec3(0.0f);
+            for (const glm::vec3 &p : shown)
+                centroid += p / float(n);
+        });
+        timer.Reset();
+        for (int f = 0; f < frames; ++f)
+        {
+            time += dt;
+            scheduler.Tick(dt);
+        }
+        double scheduled = timer.Seconds() / frames;
+        const Scheduler::Stats &stats = scheduler.getStats(orbitSystem);
+        double orbitMs = stats.totalMs / double(std::max<size_t>(stats.runs, 1));
+        over = over || orbitMs > budgetMs * SCHEDULER_BUDGET_SLACK;
+
+        // interpolation error against the exact positions of the last frame, relative to the distance
+        float error = 0.0f;
+        for (size_t i = 0; i < n; ++i)
+        {
+            glm::vec3 velocity;
+            orbits.State(i, time, exact[i], velocity);
+            error = std::max(error, glm::length(exact[i] - shown[i]) / glm::length(exact[i]));
+        }
+        std::printf("%8zu %12.3f %14.3f %10.0f %10.0f %6d %14.5f %12zu\n", n, full * 1e3, scheduled * 1e3,
+                    double(updated) / frames, double(carried) / frames, staggered.getBias(), error,
+                    scheduler.getStats(statsSystem).deferred);
+    }
+    std::printf("orbit system per frame %s the %.2f ms budget\n", over ? "OVER" : "within", budgetMs);
+    return over ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include "../src/Snapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+// snapshot [bodies] [path]
+int BenchSnapshot(const std::vector<std::string> &args)
+{
+    size_t n = args.size() > 0 ? std::stoul(args[0]) : 1000000;
+    std::string path = args.size() > 1 ? args[1] : "/tmp/SnapshotBench.bin";
+
+    Bodies bodies;
+    MakeDisk(bodies, n);
+    SnapshotClock clock{ 1234.5, 10.0f, 0, 1, 0 };
+    SnapshotCamera camera{};
+    camera.fov = 45.0f;
+    double megabytes = double(n) * SNAPSHOT_ARRAYS * sizeof(float) / (1024.0 * 1024.0);
+
+    Timer timer;
+    int repeats = 0;
+    do {
+        if (!Snapshot::Save(path, bodies, clock, camera))
+            return 1;
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    double save = timer.Seconds() / repeats;
+
+    // a fresh mapping and a full copy every time, as when jumping between saved states
+    Bodies restored;
+    timer.Reset();
+    repeats = 0;
+    do {
+        Snapshot snapshot;
+        if (!snapshot.Open(path))
+            return 1;
+        snapshot.Restore(restored);
+        ++repeats;
+    } while (timer.Seconds() < 0.5);
+    double restore = timer.Seconds() / repeats;
+
+    Snapshot snapshot;
+    snapshot.Open(path);
+    bool same = restored.Size() == n && snapshot.getClock().simTime == clock.simTime
+            && snapshot.getCamera().fov == camera.fov;
+    for (std::vector<float> Bodies::*array : { &Bodies::x, &Bodies::vz, &Bodies::az, &Bodies::radius })
+        same = same && std::memcmp((restored.*array).data(), (bodies.*array).data(), n * sizeof(float)) == 0;
+    unlink(path.c_str());
+
+    std::printf("%zu bodies, %.1f MB of arrays\n", n, megabytes);
+    std::printf("%-10s %10s %10s\n", "", "ms", "MB/s");
+    std::printf("%-10s %10.2f %10.0f\n", "save", save * 1e3, megabytes / save);
+    std::printf("%-10s %10.2f %10.0f\n", "restore", restore * 1e3, megabytes / restore);
+    std::printf("round trip %s\n", same ? "identical" : "DIFFERS");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bench.h"
+#include <glad/glad.h>
+#include "../src/NullGL.h"
+#include "../src/GLIntercept.h"
+#include "../src/Shader.h"
+#include "../src/UniformBuffer.h"
+#include "../src/VertexArray.h"
+#include "../src/VertexBuffer.h"
+
+#include <cstdio>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "ShaderUniforms.h"
+
+// once a frame: binding the frame block's buffer and filling it
+#define SUBMISSION_FRAME_CALLS 2
+
+// submission [draws] [shader]
+int BenchSubmission(const std::vector<std::string> &args)
+{
+    size_t draws = args.size() > 0 ? std::stoul(args[0]) : 10000;
+    std::string path = args.size() > 1 ? args[1] : "../res/Orbit.shader";
+
+    // no driver at all: only what our side of the API costs is measured
+    if (!gladLoadGLLoader((GLADloadproc) NullGLLoader) || !GLIntercept::Enable("")) {
+        std::printf("Failed to load the null GL backend\n");
+        return 1;
+    }
+    ShaderProgramSource source = Shader::Parse(path);
+    if (source.VertexSource.empty() || source.FragmentSource.empty()) {
+        std::printf("Failed to load the shader %s\n", path.c_str());
+        return 1;
+    }
+    Shader shader(path);
+    VertexArray vao;
+    std::vector<float> vertices(3 * 4096, 1.0f);
+    VertexBuffer vbo(vertices.data(), unsigned(vertices.size() * sizeof(float)));
+    UniformBuffer frameUBO(sizeof(Uniforms::FrameBlock), Uniforms::FrameBlock::Binding);
+    Uniforms::FrameBlock frameBlock{};
+    frameBlock.projection = glm::mat4(1.0f);
+    frameBlock.view = glm::mat4(1.0f);
+    glm::vec3 color(0.4f, 0.6f, 0.9f);
+    UniformId colorId = Uniforms::Orbit(shader).color;
+    GLIntercept::EndFrame(false);
+
+    auto Submit = [&]() {
+        frameUBO.Update(&frameBlock, sizeof(frameBlock));
+        for (size_t i = 0; i < draws; ++i)
+        {
+            shader.Use();
+            shader.setVec3f(colorId, glm::value_ptr(color));
+            vao.Bind();
+            glDrawArrays(GL_LINE_STRIP, 0, 4096);
+            vao.Unbind();
+        }
+    };
+
+    Timer timer;
+    int frames = 0;
+    uint32_t calls = 0;
+    do {
+        Submit();
+        GLIntercept::Frame frame = GLIntercept::EndFrame(false);
+        calls = 0;
+        for (uint32_t count : frame.calls)
+            calls += count;
+        ++frames;
+    } while (timer.Seconds() < 0.5);
+    double submit = timer.Seconds() / frames;
+
+    // buffer uploads, the null driver copies nothing so this is the wrapper and call overhead
+    timer.Reset();
+    size_t updates = 0;
+    do {
+        for (int k = 0; k < 1000; ++k)
+            vbo.Update(vertices.data(), unsigned(vertices.size() * sizeof(float)));
+        updates += 1000;
+    } while (timer.Seconds() < 0.2);
+    double update = timer.Seconds() / double(updates);
+
+    double perDraw = double(calls - SUBMISSION_FRAME_CALLS) / double(draws);
+    std::printf("%zu draws per frame, null GL with counting\n", draws);
+    std::printf("%-16s %12s %12s\n", "", "us/frame", "ns/draw");
+    std::printf("%-16s %12.1f %12.1f\n", "submission", submit * 1e6, submit * 1e9 / double(draws));
+    std::printf("%-16s %12s %12.1f\n", "buffer update", "", update * 1e9);
+    std::printf("GL calls per draw %.1f\n", perDraw);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#shader vertex
+#version 430 core
+#include "Frame.glsl"
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+// body state written by the N-body compute shader
+layout (std430, binding = 0) readonly buffer Positions { vec4 positions[]; };
+layout (std430, binding = 2) readonly buffer Velocities { vec4 velocities[]; };
+
+uniform int baseInstance;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+flat out vec3 LightPos;
+
+void main()
+{
+    int id = baseInstance + gl_InstanceID;
+    // sphere poles are on z, turn them to y like the model matrices of main.cpp do
+    vec3 pos = vec3(aPos.x, aPos.z, -aPos.y);
+
+    FragPos = positions[id].xyz + velocities[id].w * pos;
+    Normal = vec3(aNormal.x, aNormal.z, -aNormal.y);
+    TexCoord = aTexCoord;
+    // body 0 is the Sun
+    LightPos = positions[0].xyz;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+};
+
+#shader fragment
+#version 430 core
+#include "Light.glsl"
+out vec4 FragColor;
+
+// EMISSIVE: the Sun, glowing in the light color instead of being lit
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+flat in vec3 LightPos;
+
+uniform sampler2D texture1;
+
+void main()
+{
+    vec3 color = texture(texture1, TexCoord).rgb;
+#ifdef EMISSIVE
+    FragColor = mix(vec4(lightColor, 1.0), vec4(color, 1.0), 0.5);
+#else
+    FragColor = vec4(AmbientDiffuse(LightPos, FragPos, Normal, color), 1.0);
+#endif
+};
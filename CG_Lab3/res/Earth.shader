@@ -1,5 +1,6 @@
 #shader vertex
 #version 330 core
+#include "Frame.glsl"
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
@@ -9,8 +10,6 @@ out vec3 Normal;
 out vec2 TexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
@@ -23,54 +22,32 @@ void main()
 
 #shader fragment
 #version 330 core
+#include "Light.glsl"
 out vec4 FragColor;
 
+// SPECULAR: Phong highlights, the variant without it skips the whole term
 struct Material {
     sampler2D diffuse;
-//     vec3 specular;
-//     float shininess;
-};
-
-struct Light {
-    vec3 position;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
 };
 
 in vec3 Normal;
 in vec3 FragPos;
 in vec2 TexCoord;
 
-// uniform vec3 viewPos;
-uniform vec3 lightPos;
-uniform vec3 ourColor;
-uniform vec3 lightColor;
-
 uniform Material material;
-uniform Light light;
 
 void main()
 {
-    // ambient
-    vec3 ambient = light.ambient * texture(material.diffuse, TexCoord).rgb;
-
-    // diffuse
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(light.position - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * texture(material.diffuse, TexCoord).rgb;
-
-//     // specular
-//     float specularStrength = 0.5;
-//     vec3 viewDir = normalize(viewPos - FragPos);
-//     vec3 reflectDir = reflect(-lightDir, norm);
-//     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-//     vec3 specular = specularStrength * spec * lightColor;
-
-//     vec3 result = (ambient + diffuse + specular) * ourColor;
-    vec3 result = ambient + diffuse;
+    vec3 color = texture(material.diffuse, TexCoord).rgb;
+    vec3 result = AmbientDiffuse(lightPosition, FragPos, Normal, color);
+
+#ifdef SPECULAR
+    float specularStrength = 0.5;
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-normalize(lightPosition - FragPos), normalize(Normal));
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    result += specularStrength * spec * lightColor;
+#endif
 
     FragColor = vec4(result, 1.0);
 };
\ No newline at end of file
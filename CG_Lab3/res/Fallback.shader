@@ -0,0 +1,20 @@
+#shader vertex
+#version 330 core
+#include "Frame.glsl"
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model = mat4(1.0);
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+};
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(0.5, 0.5, 0.5, 1.0);
+};
@@ -0,0 +1,11 @@
+// per-frame values of the scene shaders, one uniform buffer written once a frame from
+// Uniforms::FrameBlock of the generated ShaderUniforms.h; #include "Frame.glsl" after #version
+layout (std140) uniform Frame {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+    vec3 lightColor;
+    vec3 lightPosition;
+    vec3 lightAmbient;
+    vec3 lightDiffuse;
+};
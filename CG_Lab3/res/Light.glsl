@@ -0,0 +1,10 @@
+// point light of the lit shaders, #include "Light.glsl" after #version
+#include "Frame.glsl"
+
+// ambient and Lambert diffuse light on a surface of the given color
+vec3 AmbientDiffuse(vec3 lightPos, vec3 fragPos, vec3 normal, vec3 color)
+{
+    vec3 lightDir = normalize(lightPos - fragPos);
+    float diff = max(dot(normalize(normal), lightDir), 0.0);
+    return lightAmbient * color + lightDiffuse * diff * color;
+}
@@ -0,0 +1,48 @@
+#shader compute
+#version 430 core
+layout (local_size_x = 128) in;
+
+// xyz = position, w = mass; read from one buffer, written to the other
+layout (std430, binding = 0) readonly buffer PositionsIn { vec4 positionsIn[]; };
+layout (std430, binding = 1) writeonly buffer PositionsOut { vec4 positionsOut[]; };
+// xyz = velocity, w = radius
+layout (std430, binding = 2) buffer Velocities { vec4 velocities[]; };
+
+uniform int count;
+uniform float dt;
+uniform float gravity;
+uniform float softening;
+
+shared vec4 tile[128];
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    vec4 self = i < count ? positionsIn[i] : vec4(0.0);
+    float eps2 = softening * softening;
+    vec3 acc = vec3(0.0);
+
+    // every work group walks all bodies in tiles staged through shared memory
+    for (int base = 0; base < count; base += 128)
+    {
+        int j = base + int(gl_LocalInvocationID.x);
+        tile[gl_LocalInvocationID.x] = j < count ? positionsIn[j] : vec4(0.0);
+        barrier();
+        for (int k = 0; k < 128; ++k)
+        {
+            vec3 d = tile[k].xyz - self.xyz;
+            float inv = inversesqrt(dot(d, d) + eps2);
+            acc += d * (tile[k].w * inv * inv * inv);
+        }
+        barrier();
+    }
+
+    if (i >= count)
+        return;
+
+    // kick then drift, velocities stay half a step ahead of the positions
+    vec4 v = velocities[i];
+    v.xyz += gravity * acc * dt;
+    velocities[i] = v;
+    positionsOut[i] = vec4(self.xyz + v.xyz * dt, self.w);
+};
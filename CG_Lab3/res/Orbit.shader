@@ -0,0 +1,20 @@
+#shader vertex
+#version 330 core
+#include "Frame.glsl"
+layout (location = 0) in vec3 aPos;
+
+void main()
+{
+    gl_Position = projection * view * vec4(aPos, 1.0);
+};
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+uniform vec3 color;
+
+void main()
+{
+    FragColor = vec4(color, 1.0);
+};
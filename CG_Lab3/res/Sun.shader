@@ -1,12 +1,11 @@
 #shader vertex
 #version 330 core
+#include "Frame.glsl"
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 out vec2 TexCoord;
 
@@ -18,10 +17,10 @@ void main()
 
 #shader fragment
 #version 330 core
+#include "Frame.glsl"
 out vec4 FragColor;
 
 uniform sampler2D texture1;
-uniform vec3 lightColor;
 
 in vec2 TexCoord;
 
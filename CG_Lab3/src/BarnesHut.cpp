@@ -0,0 +1,391 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "BarnesHut.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#define MORTON_LEVELS 21
+
+// spreads the low 21 bits of v so that there are two zero bits between each of them
+static inline uint64_t ExpandBits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8) & 0x100f00f00f00f00full;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
+}
+
+// octant of the key below a node of the given level
+static inline int Octant(uint64_t key, int level)
+{
+    return int(key >> (3 * (MORTON_LEVELS - 1 - level))) & 7;
+}
+
+BarnesHut::BarnesHut(ThreadPool &pool, float theta, float softening, int leafCapacity)
+        : mPool(pool), mTheta(theta), mSoftening(softening), mLeafCapacity(leafCapacity), mMin{0.0f, 0.0f, 0.0f}, mSize(1.0f) {
+
+}
+
+BarnesHut::~BarnesHut() {
+
+}
+
+void BarnesHut::Build(const Bodies &bodies) {
+    this->mNodes.clear();
+    if (bodies.Size() == 0)
+        return;
+
+    this->ComputeBounds(bodies);
+    this->ComputeKeys(bodies);
+    this->SortKeys();
+
+    // gather positions in Morton order, the force pass walks them linearly
+    size_t n = bodies.Size();
+    this->mX.resize(n);
+    this->mY.resize(n);
+    this->mZ.resize(n);
+    this->mMass.resize(n);
+    this->mPool.ParallelFor(n, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint32_t b = this->mOrder[i];
+            this->mX[i] = bodies.x[b];
+            this->mY[i] = bodies.y[b];
+            this->mZ[i] = bodies.z[b];
+            this->mMass[i] = bodies.mass[b];
+        }
+    });
+
+    this->BuildNodes();
+}
+
+void BarnesHut::ComputeBounds(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    size_t chunks = this->mPool.Size() * 4;
+    size_t grain = (n + chunks - 1) / chunks;
+    std::vector<float> partial(chunks * 6);
+
+    for (size_t c = 0; c < chunks; ++c)
+    {
+        partial[c*6 + 0] = partial[c*6 + 1] = partial[c*6 + 2] = INFINITY;
+        partial[c*6 + 3] = partial[c*6 + 4] = partial[c*6 + 5] = -INFINITY;
+    }
+
+    this->mPool.ParallelFor(n, grain, [&](size_t begin, size_t end) {
+        float lo[3] = { INFINITY, INFINITY, INFINITY };
+        float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (size_t i = begin; i < end; ++i)
+        {
+            lo[0] = std::min(lo[0], bodies.x[i]); hi[0] = std::max(hi[0], bodies.x[i]);
+            lo[1] = std::min(lo[1], bodies.y[i]); hi[1] = std::max(hi[1], bodies.y[i]);
+            lo[2] = std::min(lo[2], bodies.z[i]); hi[2] = std::max(hi[2], bodies.z[i]);
+        }
+        float *out = &partial[(begin / grain) * 6];
+        for (int k = 0; k < 3; ++k)
+        {
+            out[k] = lo[k];
+            out[k + 3] = hi[k];
+        }
+    });
+
+    float lo[3] = { INFINITY, INFINITY, INFINITY };
+    float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (size_t c = 0; c < chunks; ++c)
+        for (int k = 0; k < 3; ++k)
+        {
+            lo[k] = std::min(lo[k], partial[c*6 + k]);
+            hi[k] = std::max(hi[k], partial[c*6 + k + 3]);
+        }
+
+    // cubic root cell, slightly inflated so that the far faces still map inside the grid
+    float size = std::max(hi[0] - lo[0], std::max(hi[1] - lo[1], hi[2] - lo[2]));
+    size = std::max(size * 1.001f, 1e-6f);
+    for (int k = 0; k < 3; ++k)
+        this->mMin[k] = lo[k];
+    this->mSize = size;
+}
+
+void BarnesHut::ComputeKeys(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    this->mKeys.resize(n);
+    this->mOrder.resize(n);
+
+    const float scale = float((1u << MORTON_LEVELS) - 1) / this->mSize;
+    this->mPool.ParallelFor(n, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto qx = uint64_t((bodies.x[i] - this->mMin[0]) * scale);
+            auto qy = uint64_t((bodies.y[i] - this->mMin[1]) * scale);
+            auto qz = uint64_t((bodies.z[i] - this->mMin[2]) * scale);
+            this->mKeys[i] = ExpandBits(qx) << 2 | ExpandBits(qy) << 1 | ExpandBits(qz);
+            this->mOrder[i] = uint32_t(i);
+        }
+    });
+}
+
+void BarnesHut::SortKeys() {
+    typedef std::pair<uint64_t, uint32_t> KeyIndex;
+    size_t n = this->mKeys.size();
+    std::vector<KeyIndex> pairs(n);
+    for (size_t i = 0; i < n; ++i)
+        pairs[i] = KeyIndex(this->mKeys[i], this->mOrder[i]);
+
+    // sort one run per thread, then merge neighbouring runs pairwise in parallel
+    size_t runs = this->mPool.Size();
+    size_t run = std::max<size_t>((n + runs - 1) / runs, 1);
+    this->mPool.ParallelFor(n, run, [&](size_t begin, size_t end) {
+        std::sort(pairs.begin() + begin, pairs.begin() + end);
+    });
+    for (size_t width = run; width < n; width *= 2)
+    {
+        size_t merges = (n + 2*width - 1) / (2*width);
+        this->mPool.ParallelFor(merges, 1, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; ++m)
+            {
+                size_t lo = m * 2 * width;
+                size_t mid = std::min(lo + width, n);
+                size_t hi = std::min(lo + 2*width, n);
+                std::inplace_merge(pairs.begin() + lo, pairs.begin() + mid, pairs.begin() + hi);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        this->mKeys[i] = pairs[i].first;
+        this->mOrder[i] = pairs[i].second;
+    }
+}
+
+void BarnesHut::Split(std::vector<Node> &nodes, int index) const {
+    Node parent = nodes[index];
+    if (parent.end - parent.begin <= this->mLeafCapacity || parent.level >= MORTON_LEVELS)
+        return;
+
+    int first = int(nodes.size());
+    int count = 0;
+    float quarter = parent.halfSize * 0.5f;
+    auto keys = this->mKeys.begin();
+    int begin = parent.begin;
+
+    // keys of the node share their prefix, so each octant is one contiguous run
+    while (begin < parent.end)
+    {
+        int octant = Octant(this->mKeys[begin], parent.level);
+        int end = int(std::upper_bound(keys + begin, keys + parent.end, octant,
+                                       [&](int oct, uint64_t key) { return oct < Octant(key, parent.level); }) - keys);
+        Node child{};
+        child.centerX = parent.centerX + ((octant & 4) ? quarter : -quarter);
+        child.centerY = parent.centerY + ((octant & 2) ? quarter : -quarter);
+        child.centerZ = parent.centerZ + ((octant & 1) ? quarter : -quarter);
+        child.halfSize = quarter;
+        child.firstChild = -1;
+        child.childCount = 0;
+        child.begin = begin;
+        child.end = end;
+        child.level = parent.level + 1;
+        nodes.push_back(child);
+        ++count;
+        begin = end;
+    }
+
+    nodes[index].firstChild = first;
+    nodes[index].childCount = count;
+}
+
+void BarnesHut::BuildSubtree(std::vector<Node> &nodes, int index) const {
+    this->Split(nodes, index);
+    int first = nodes[index].firstChild;
+    int count = nodes[index].childCount;
+    for (int c = 0; c < count; ++c)
+        this->BuildSubtree(nodes, first + c);
+    // children are complete here, so moments go up the tree bottom-up
+    this->Aggregate(nodes, index);
+}
+
+void BarnesHut::Aggregate(std::vector<Node> &nodes, int index) const {
+    Node &node = nodes[index];
+    double mass = 0.0, x = 0.0, y = 0.0, z = 0.0;
+
+    if (node.childCount == 0)
+    {
+        for (int i = node.begin; i < node.end; ++i)
+        {
+            mass += this->mMass[i];
+            x += double(this->mMass[i]) * this->mX[i];
+            y += double(this->mMass[i]) * this->mY[i];
+            z += double(this->mMass[i]) * this->mZ[i];
+        }
+    }
+    else
+    {
+        for (int c = node.firstChild; c < node.firstChild + node.childCount; ++c)
+        {
+            const Node &child = nodes[c];
+            mass += child.mass;
+            x += double(child.mass) * child.comX;
+            y += double(child.mass) * child.comY;
+            z += double(child.mass) * child.comZ;
+        }
+    }
+
+    node.mass = float(mass);
+    if (mass > 0.0)
+    {
+        node.comX = float(x / mass);
+        node.comY = float(y / mass);
+        node.comZ = float(z / mass);
+    }
+    else
+    {
+        node.comX = node.centerX;
+        node.comY = node.centerY;
+        node.comZ = node.centerZ;
+    }
+}
+
+void BarnesHut::BuildNodes() {
+    std::vector<Node> &nodes = this->mNodes;
+    Node root{};
+    root.halfSize = this->mSize * 0.5f;
+    root.centerX = this->mMin[0] + root.halfSize;
+    root.centerY = this->mMin[1] + root.halfSize;
+    root.centerZ = this->mMin[2] + root.halfSize;
+    root.firstChild = -1;
+    root.begin = 0;
+    root.end = int(this->mKeys.size());
+    nodes.push_back(root);
+
+    // open the top levels serially until there is enough independent subtrees for every thread
+    std::vector<int> frontier(1, 0);
+    size_t wanted = this->mPool.Size() * 8;
+    while (frontier.size() < wanted)
+    {
+        std::vector<int> next;
+        bool split = false;
+        for (int f : frontier)
+        {
+            this->Split(nodes, f);
+            if (nodes[f].childCount == 0)
+            {
+                next.push_back(f);
+                continue;
+            }
+            split = true;
+            for (int c = 0; c < nodes[f].childCount; ++c)
+                next.push_back(nodes[f].firstChild + c);
+        }
+        frontier.swap(next);
+        if (!split)
+            break;
+    }
+    int top = int(nodes.size());
+
+    // every frontier subtree is built into its own array
+    std::vector<std::vector<Node>> subtrees(frontier.size());
+    this->mPool.ParallelFor(frontier.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s)
+        {
+            subtrees[s].push_back(nodes[frontier[s]]);
+            this->BuildSubtree(subtrees[s], 0);
+        }
+    });
+
+    // splice the subtrees behind the top levels and rebase their child indices
+    std::vector<int> base(frontier.size());
+    int total = top;
+    for (size_t s = 0; s < frontier.size(); ++s)
+    {
+        base[s] = total - 1;
+        total += int(subtrees[s].size()) - 1;
+    }
+    nodes.resize(total);
+    this->mPool.ParallelFor(frontier.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s)
+        {
+            std::vector<Node> &local = subtrees[s];
+            for (size_t k = 0; k < local.size(); ++k)
+            {
+                Node node = local[k];
+                if (node.childCount > 0)
+                    node.firstChild += base[s];
+                nodes[k == 0 ? frontier[s] : base[s] + int(k)] = node;
+            }
+        }
+    });
+
+    // the top levels have larger indices for children than for parents
+    for (int i = top - 1; i >= 0; --i)
+        this->Aggregate(nodes, i);
+}
+
+void BarnesHut::Accelerate(int sorted, float &ax, float &ay, float &az) const {
+    const float px = this->mX[sorted], py = this->mY[sorted], pz = this->mZ[sorted];
+    const float eps2 = this->mSoftening * this->mSoftening;
+    const float theta2 = this->mTheta * this->mTheta;
+    float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+
+    int stack[8 * (MORTON_LEVELS + 1)];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node &node = this->mNodes[stack[--top]];
+        bool inside = sorted >= node.begin && sorted < node.end;
+
+        if (node.childCount == 0)
+        {
+            for (int j = node.begin; j < node.end; ++j)
+            {
+                if (j == sorted)
+                    continue;
+                float dx = this->mX[j] - px, dy = this->mY[j] - py, dz = this->mZ[j] - pz;
+                float d2 = dx*dx + dy*dy + dz*dz + eps2;
+                float inv = 1.0f / std::sqrt(d2);
+                float s = this->mMass[j] * inv * inv * inv;
+                sx += dx * s; sy += dy * s; sz += dz * s;
+            }
+            continue;
+        }
+
+        float dx = node.comX - px, dy = node.comY - py, dz = node.comZ - pz;
+        float d2 = dx*dx + dy*dy + dz*dz + eps2;
+        float width = 2.0f * node.halfSize;
+        if (!inside && width * width < theta2 * d2)
+        {
+            // far enough: the whole cell acts as one point mass
+            float inv = 1.0f / std::sqrt(d2);
+            float s = node.mass * inv * inv * inv;
+            sx += dx * s; sy += dy * s; sz += dz * s;
+        }
+        else
+        {
+            for (int c = 0; c < node.childCount; ++c)
+                stack[top++] = node.firstChild + c;
+        }
+    }
+
+    ax = GRAVITY * sx;
+    ay = GRAVITY * sy;
+    az = GRAVITY * sz;
+}
+
+void BarnesHut::ComputeAccelerations(Bodies &bodies) const {
+    if (this->mNodes.empty())
+        return;
+    this->mPool.ParallelFor(this->mOrder.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint32_t b = this->mOrder[i];
+            this->Accelerate(int(i), bodies.ax[b], bodies.ay[b], bodies.az[b]);
+        }
+    });
+}
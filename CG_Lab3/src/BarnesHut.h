@@ -0,0 +1,63 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_BARNESHUT_H
+#define PROJECT_BARNESHUT_H
+
+#include <cstdint>
+#include <vector>
+#include "Bodies.h"
+#include "ThreadPool.h"
+
+
+// Barnes-Hut octree rebuilt every step from Morton-sorted bodies
+class BarnesHut {
+private:
+    struct Node
+    {
+        float comX, comY, comZ, mass;      // centre of mass
+        float centerX, centerY, centerZ;   // cell geometry
+        float halfSize;
+        int firstChild;                    // children are stored contiguously
+        int childCount;                    // 0 for a leaf
+        int begin, end;                    // range of sorted bodies
+        int level;
+    };
+
+    ThreadPool &mPool;
+    float mTheta;
+    float mSoftening;
+    int mLeafCapacity;
+
+    std::vector<Node> mNodes;
+    std::vector<uint64_t> mKeys;
+    std::vector<uint32_t> mOrder;                // sorted index -> body index
+    std::vector<float> mX, mY, mZ, mMass;        // bodies in sorted order
+    float mMin[3];
+    float mSize;
+
+    void ComputeBounds(const Bodies &bodies);
+    void ComputeKeys(const Bodies &bodies);
+    void SortKeys();
+    void BuildNodes();
+    void Split(std::vector<Node> &nodes, int index) const;
+    void BuildSubtree(std::vector<Node> &nodes, int index) const;
+    void Aggregate(std::vector<Node> &nodes, int index) const;
+    void Accelerate(int sorted, float &ax, float &ay, float &az) const;
+public:
+    BarnesHut(ThreadPool &pool, float theta = 0.5f, float softening = SOFTENING, int leafCapacity = 8);
+    ~BarnesHut();
+
+    inline void setTheta(float theta) { this->mTheta = theta; }
+    inline float getTheta() const { return this->mTheta; }
+    inline size_t getNodeCount() const { return this->mNodes.size(); }
+
+    // builds the tree for the current positions
+    void Build(const Bodies &bodies);
+    // writes bodies.ax/ay/az from the last built tree
+    void ComputeAccelerations(Bodies &bodies) const;
+};
+
+
+#endif //PROJECT_BARNESHUT_H
@@ -0,0 +1,55 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_BODIES_H
+#define PROJECT_BODIES_H
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// gravitational constant in scene units
+#define GRAVITY 1.0f
+// Plummer softening length shared by all force kernels
+#define SOFTENING 0.01f
+
+// structure of arrays with the state of every simulated body
+struct Bodies
+{
+    std::vector<float> x, y, z;       // position
+    std::vector<float> vx, vy, vz;    // velocity
+    std::vector<float> ax, ay, az;    // acceleration of the last force pass
+    std::vector<float> mass;
+    std::vector<float> radius;        // render and bounding sphere radius
+
+    inline size_t Size() const { return this->x.size(); }
+
+    inline glm::vec3 Position(size_t i) const { return glm::vec3(this->x[i], this->y[i], this->z[i]); }
+    inline glm::vec3 Velocity(size_t i) const { return glm::vec3(this->vx[i], this->vy[i], this->vz[i]); }
+
+    size_t Add(const glm::vec3 &position, const glm::vec3 &velocity, float bodyMass, float bodyRadius)
+    {
+        this->x.push_back(position.x);
+        this->y.push_back(position.y);
+        this->z.push_back(position.z);
+        this->vx.push_back(velocity.x);
+        this->vy.push_back(velocity.y);
+        this->vz.push_back(velocity.z);
+        this->ax.push_back(0.0f);
+        this->ay.push_back(0.0f);
+        this->az.push_back(0.0f);
+        this->mass.push_back(bodyMass);
+        this->radius.push_back(bodyRadius);
+        return this->Size() - 1;
+    }
+
+    void Clear()
+    {
+        for (std::vector<float> *v : { &x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &mass, &radius })
+            v->clear();
+    }
+};
+
+
+#endif //PROJECT_BODIES_H
@@ -0,0 +1,233 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Bvh.h"
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+// deep enough for a median split tree over 2^32 bodies
+#define BVH_STACK 64
+
+Bvh::Bvh() {
+
+}
+
+Bvh::~Bvh() {
+
+}
+
+void Bvh::CopySphere(const Bodies &bodies, int slot) {
+    uint32_t b = this->mOrder[slot];
+    this->mX[slot] = bodies.x[b];
+    this->mY[slot] = bodies.y[b];
+    this->mZ[slot] = bodies.z[b];
+    this->mRadius[slot] = bodies.radius[b];
+}
+
+void Bvh::FitLeaf(Node &node) const {
+    for (int k = 0; k < 3; ++k)
+    {
+        node.min[k] = INFINITY;
+        node.max[k] = -INFINITY;
+    }
+    for (int s = node.first; s < node.first + node.count; ++s)
+    {
+        float r = this->mRadius[s];
+        node.min[0] = std::min(node.min[0], this->mX[s] - r); node.max[0] = std::max(node.max[0], this->mX[s] + r);
+        node.min[1] = std::min(node.min[1], this->mY[s] - r); node.max[1] = std::max(node.max[1], this->mY[s] + r);
+        node.min[2] = std::min(node.min[2], this->mZ[s] - r); node.max[2] = std::max(node.max[2], this->mZ[s] + r);
+    }
+}
+
+void Bvh::FitInner(Node &node) const {
+    const Node &left = this->mNodes[node.first], &right = this->mNodes[node.first + 1];
+    for (int k = 0; k < 3; ++k)
+    {
+        node.min[k] = std::min(left.min[k], right.min[k]);
+        node.max[k] = std::max(left.max[k], right.max[k]);
+    }
+}
+
+// splits slots [begin, end) at the median centre along the widest axis of the centres;
+// the two children are allocated together, so the right one is always first + 1
+void Bvh::BuildNode(const Bodies &bodies, int index, int begin, int end) {
+    if (end - begin <= BVH_LEAF_SIZE) {
+        Node &node = this->mNodes[index];
+        node.first = begin;
+        node.count = end - begin;
+        for (int s = begin; s < end; ++s)
+        {
+            this->CopySphere(bodies, s);
+            this->mSlotOf[this->mOrder[s]] = uint32_t(s);
+            this->mLeafOf[this->mOrder[s]] = uint32_t(index);
+        }
+        this->FitLeaf(node);
+        return;
+    }
+
+    float lo[3] = { INFINITY, INFINITY, INFINITY };
+    float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (int s = begin; s < end; ++s)
+    {
+        uint32_t b = this->mOrder[s];
+        lo[0] = std::min(lo[0], bodies.x[b]); hi[0] = std::max(hi[0], bodies.x[b]);
+        lo[1] = std::min(lo[1], bodies.y[b]); hi[1] = std::max(hi[1], bodies.y[b]);
+        lo[2] = std::min(lo[2], bodies.z[b]); hi[2] = std::max(hi[2], bodies.z[b]);
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+        if (hi[k] - lo[k] > hi[axis] - lo[axis])
+            axis = k;
+    const float *centre = axis == 0 ? bodies.x.data() : axis == 1 ? bodies.y.data() : bodies.z.data();
+
+    int mid = begin + (end - begin) / 2;
+    std::nth_element(this->mOrder.begin() + begin, this->mOrder.begin() + mid, this->mOrder.begin() + end,
+                     [centre](uint32_t a, uint32_t b) { return centre[a] < centre[b]; });
+
+    int first = int(this->mNodes.size());
+    this->mNodes.push_back(Node{ {}, {}, 0, 0, index });
+    this->mNodes.push_back(Node{ {}, {}, 0, 0, index });
+    this->mNodes[index].first = first;
+    this->mNodes[index].count = 0;
+    this->BuildNode(bodies, first, begin, mid);
+    this->BuildNode(bodies, first + 1, mid, end);
+    this->FitInner(this->mNodes[index]);
+}
+
+void Bvh::Build(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    this->mOrder.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        this->mOrder[i] = uint32_t(i);
+    this->mSlotOf.resize(n);
+    this->mLeafOf.resize(n);
+    this->mX.resize(n);
+    this->mY.resize(n);
+    this->mZ.resize(n);
+    this->mRadius.resize(n);
+
+    this->mNodes.clear();
+    this->mNodes.reserve(2 * (n / BVH_LEAF_SIZE + 1));
+    if (n == 0)
+        return;
+    this->mNodes.push_back(Node{ {}, {}, 0, 0, -1 });
+    this->BuildNode(bodies, 0, 0, int(n));
+}
+
+// children always have larger indices than their parent, a reverse walk is bottom-up
+void Bvh::Refit(const Bodies &bodies) {
+    for (int s = 0; s < int(this->mOrder.size()); ++s)
+        this->CopySphere(bodies, s);
+    for (int i = int(this->mNodes.size()) - 1; i >= 0; --i)
+    {
+        Node &node = this->mNodes[i];
+        if (node.count > 0)
+            this->FitLeaf(node);
+        else
+            this->FitInner(node);
+    }
+}
+
+void Bvh::Refit(const Bodies &bodies, const std::vector<uint32_t> &moved) {
+    for (uint32_t body : moved)
+        this->CopySphere(bodies, int(this->mSlotOf[body]));
+
+    for (uint32_t body : moved)
+    {
+        int index = int(this->mLeafOf[body]);
+        this->FitLeaf(this->mNodes[index]);
+        for (int parent = this->mNodes[index].parent; parent >= 0; parent = this->mNodes[parent].parent)
+        {
+            Node &node = this->mNodes[parent];
+            Node before = node;
+            this->FitInner(node);
+            if (std::equal(before.min, before.min + 3, node.min) && std::equal(before.max, before.max + 3, node.max))
+                break;
+        }
+    }
+}
+
+// slab test, entry distance or INFINITY on a miss
+static inline float EnterBox(const float *min, const float *max, const glm::vec3 &origin, const glm::vec3 &inverse,
+                             float maxDistance)
+{
+    float t0 = 0.0f, t1 = maxDistance;
+    for (int k = 0; k < 3; ++k)
+    {
+        float a = (min[k] - origin[k]) * inverse[k];
+        float b = (max[k] - origin[k]) * inverse[k];
+        t0 = std::max(t0, std::min(a, b));
+        t1 = std::min(t1, std::max(a, b));
+    }
+    return t0 <= t1 ? t0 : INFINITY;
+}
+
+bool Bvh::Raycast(const glm::vec3 &origin, const glm::vec3 &direction, RayHit &hit, float maxDistance) const {
+    if (this->mNodes.empty())
+        return false;
+    glm::vec3 d = glm::normalize(direction);
+    glm::vec3 inverse = 1.0f / d;
+    float best = maxDistance;
+    bool found = false;
+
+    int stack[BVH_STACK];
+    int top = 0;
+    if (EnterBox(this->mNodes[0].min, this->mNodes[0].max, origin, inverse, best) == INFINITY)
+        return false;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = this->mNodes[stack[--top]];
+        if (node.count > 0) {
+            for (int s = node.first; s < node.first + node.count; ++s)
+            {
+                glm::vec3 oc = glm::vec3(this->mX[s], this->mY[s], this->mZ[s]) - origin;
+                float tca = glm::dot(oc, d);
+                float r2 = this->mRadius[s] * this->mRadius[s];
+                // distance to the line from the perpendicular itself, |oc|^2 - tca^2 cancels badly far away
+                glm::vec3 perpendicular = oc - tca * d;
+                float d2 = glm::dot(perpendicular, perpendicular);
+                if (d2 > r2)
+                    continue;
+                float thc = std::sqrt(r2 - d2);
+                // from inside a sphere the exit point counts
+                float t = tca - thc >= 0.0f ? tca - thc : tca + thc;
+                if (t >= 0.0f && t <= best) {
+                    best = t;
+                    hit.body = this->mOrder[s];
+                    hit.distance = t;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // nearer child on top of the stack, children beyond the best hit are skipped
+        float tl = EnterBox(this->mNodes[node.first].min, this->mNodes[node.first].max, origin, inverse, best);
+        float tr = EnterBox(this->mNodes[node.first + 1].min, this->mNodes[node.first + 1].max, origin, inverse, best);
+        int nearChild = node.first, farChild = node.first + 1;
+        if (tr < tl) {
+            std::swap(nearChild, farChild);
+            std::swap(tl, tr);
+        }
+        if (tr != INFINITY)
+            stack[top++] = farChild;
+        if (tl != INFINITY)
+            stack[top++] = nearChild;
+    }
+    return found;
+}
+
+void ScreenRay(double x, double y, int width, int height, const glm::mat4 &projection, const glm::mat4 &view,
+               glm::vec3 &origin, glm::vec3 &direction)
+{
+    float ndcX = float(2.0 * x / width - 1.0);
+    float ndcY = float(1.0 - 2.0 * y / height);
+    glm::mat4 inverse = glm::inverse(projection * view);
+    glm::vec4 nearPoint = inverse * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverse * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    origin = glm::vec3(nearPoint) / nearPoint.w;
+    direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+}
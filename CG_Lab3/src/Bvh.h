@@ -0,0 +1,70 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_BVH_H
+#define PROJECT_BVH_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bodies.h"
+
+// bodies per leaf
+#define BVH_LEAF_SIZE 4
+
+struct RayHit
+{
+    uint32_t body;
+    float distance;       // along the normalised ray direction
+};
+
+
+// bounding volume hierarchy over the body spheres for ray queries
+class Bvh {
+private:
+    struct Node
+    {
+        float min[3], max[3];
+        int first;            // leaf: first slot in mOrder; inner: left child, the right one follows it
+        int count;            // bodies in a leaf, 0 for an inner node
+        int parent;
+    };
+
+    std::vector<Node> mNodes;
+    std::vector<uint32_t> mOrder;            // slot -> body
+    std::vector<uint32_t> mSlotOf;           // body -> slot
+    std::vector<uint32_t> mLeafOf;           // body -> leaf node
+    // spheres in slot order, the traversal reads them linearly
+    std::vector<float> mX, mY, mZ, mRadius;
+
+    void BuildNode(const Bodies &bodies, int index, int begin, int end);
+    void FitLeaf(Node &node) const;
+    void FitInner(Node &node) const;
+    void CopySphere(const Bodies &bodies, int slot);
+public:
+    Bvh();
+    ~Bvh();
+
+    inline size_t getBodyCount() const { return this->mOrder.size(); }
+    inline size_t getNodeCount() const { return this->mNodes.size(); }
+
+    // top-down median split over all bodies
+    void Build(const Bodies &bodies);
+    // same topology, bounds recomputed bottom-up for the current positions
+    void Refit(const Bodies &bodies);
+    // only the leaves of the moved bodies and their ancestors, stops where the bounds stop changing
+    void Refit(const Bodies &bodies, const std::vector<uint32_t> &moved);
+
+    // closest sphere hit by origin + t * direction for 0 <= t <= maxDistance
+    bool Raycast(const glm::vec3 &origin, const glm::vec3 &direction, RayHit &hit,
+                 float maxDistance = INFINITY) const;
+};
+
+// world space ray through a window pixel, y grows downwards like the cursor position
+void ScreenRay(double x, double y, int width, int height, const glm::mat4 &projection, const glm::mat4 &view,
+               glm::vec3 &origin, glm::vec3 &direction);
+
+
+#endif //PROJECT_BVH_H
@@ -0,0 +1,74 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool CameraPath::Load(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Failed to open camera path " << path << std::endl;
+        return false;
+    }
+    std::vector<CameraKey> keys;
+    std::string line;
+    for (int number = 1; std::getline(file, line); ++number)
+    {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+        std::istringstream stream(line);
+        CameraKey key{};
+        std::string mode;
+        stream >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch >> key.fov >> mode;
+        if (!stream || (mode != "perspective" && mode != "ortho") || (!keys.empty() && key.time <= keys.back().time)) {
+            std::cout << "Camera path " << path << " has a wrong key on line " << number << std::endl;
+            return false;
+        }
+        key.perspective = mode == "perspective";
+        keys.push_back(key);
+    }
+    if (keys.empty()) {
+        std::cout << "Camera path " << path << " has no keys" << std::endl;
+        return false;
+    }
+    this->mKeys = std::move(keys);
+    return true;
+}
+
+CameraKey CameraPath::Sample(float time) const {
+    const std::vector<CameraKey> &keys = this->mKeys;
+    if (time <= keys.front().time)
+        return keys.front();
+    if (time >= keys.back().time)
+        return keys.back();
+
+    size_t i = size_t(std::upper_bound(keys.begin(), keys.end(), time,
+                                       [](float t, const CameraKey &key) { return t < key.time; }) - keys.begin()) - 1;
+    const CameraKey &k0 = keys[i], &k1 = keys[i + 1];
+    // neighbours for the tangents, the ends repeat themselves
+    const CameraKey &before = keys[i > 0 ? i - 1 : i], &after = keys[i + 2 < keys.size() ? i + 2 : i + 1];
+    float h = k1.time - k0.time, s = (time - k0.time) / h;
+    float s2 = s * s, s3 = s2 * s;
+    float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f, h10 = (s3 - 2.0f * s2 + s) * h;
+    float h01 = -2.0f * s3 + 3.0f * s2, h11 = (s3 - s2) * h;
+    auto Hermite = [&](auto CameraKey::*channel) {
+        auto m0 = (k1.*channel - before.*channel) / (k1.time - before.time);
+        auto m1 = (after.*channel - k0.*channel) / (after.time - k0.time);
+        return h00 * k0.*channel + h10 * m0 + h01 * k1.*channel + h11 * m1;
+    };
+
+    CameraKey key{};
+    key.time = time;
+    key.position = Hermite(&CameraKey::position);
+    key.yaw = Hermite(&CameraKey::yaw);
+    key.pitch = Hermite(&CameraKey::pitch);
+    key.fov = Hermite(&CameraKey::fov);
+    key.perspective = k0.perspective;
+    return key;
+}
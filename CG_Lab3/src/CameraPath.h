@@ -0,0 +1,41 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_CAMERAPATH_H
+#define PROJECT_CAMERAPATH_H
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct CameraKey
+{
+    float time;
+    glm::vec3 position;
+    float yaw, pitch;                  // degrees, as the free camera uses them
+    float fov;
+    bool perspective;
+};
+
+
+// keyframed camera flight for repeatable benchmarks, one key per line of a text file:
+//   time x y z yaw pitch fov perspective|ortho
+// empty lines and lines starting with # are skipped, times must increase
+class CameraPath {
+private:
+    std::vector<CameraKey> mKeys;
+public:
+    // false and a message if the file is missing or a line is malformed
+    bool Load(const std::string &path);
+
+    // position, angles and fov by cubic Hermite interpolation with finite-difference tangents,
+    // the projection mode of the key before; held at the ends
+    CameraKey Sample(float time) const;
+
+    inline float getDuration() const { return this->mKeys.empty() ? 0.0f : this->mKeys.back().time; }
+    inline size_t Size() const { return this->mKeys.size(); }
+};
+
+
+#endif //PROJECT_CAMERAPATH_H
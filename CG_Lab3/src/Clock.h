@@ -0,0 +1,17 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_CLOCK_H
+#define PROJECT_CLOCK_H
+
+#include <chrono>
+
+// wall clock milliseconds since start
+static inline double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+#endif //PROJECT_CLOCK_H
@@ -0,0 +1,330 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Collision.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+const char *BroadphaseName(Broadphase broadphase)
+{
+    switch (broadphase) {
+        case Broadphase::AUTO: return "auto";
+        case Broadphase::SWEEP: return "sort and sweep";
+        case Broadphase::HASH: return "spatial hash";
+    }
+    return "";
+}
+
+static inline uint32_t CellHash(int x, int y, int z)
+{
+    return (uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u) ^ (uint32_t(z) * 83492791u);
+}
+
+// boxes of two bounding spheres overlap
+static inline bool BoxesOverlap(const Bodies &bodies, uint32_t i, uint32_t j)
+{
+    float r = bodies.radius[i] + bodies.radius[j];
+    return std::fabs(bodies.x[i] - bodies.x[j]) <= r
+        && std::fabs(bodies.y[i] - bodies.y[j]) <= r
+        && std::fabs(bodies.z[i] - bodies.z[j]) <= r;
+}
+
+// one sorted run per thread, then pairwise merges of neighbouring runs in parallel
+template <typename T>
+static void ParallelSort(ThreadPool &pool, std::vector<T> &items)
+{
+    size_t n = items.size();
+    size_t run = std::max<size_t>((n + pool.Size() - 1) / pool.Size(), 1);
+    pool.ParallelFor(n, run, [&](size_t begin, size_t end) {
+        std::sort(items.begin() + begin, items.begin() + end);
+    });
+    for (size_t width = run; width < n; width *= 2)
+    {
+        size_t merges = (n + 2*width - 1) / (2*width);
+        pool.ParallelFor(merges, 1, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; ++m)
+            {
+                size_t lo = m * 2 * width;
+                size_t mid = std::min(lo + width, n);
+                size_t hi = std::min(lo + 2*width, n);
+                std::inplace_merge(items.begin() + lo, items.begin() + mid, items.begin() + hi);
+            }
+        });
+    }
+}
+
+Collision::Collision(ThreadPool &pool, Broadphase broadphase) : mPool(pool), mBroadphase(broadphase) {
+
+}
+
+Collision::~Collision() {
+
+}
+
+void Collision::Detect(const Bodies &bodies) {
+    auto start = std::chrono::steady_clock::now();
+    this->mStats = Stats{};
+    this->mStats.broadphase = this->Choose(bodies);
+
+    if (this->mStats.broadphase == Broadphase::SWEEP) {
+        this->SortIntervals(bodies);
+        this->mStats.buildMs = Milliseconds(start);
+        start = std::chrono::steady_clock::now();
+        this->Sweep(bodies);
+    } else {
+        this->BuildGrid(bodies);
+        this->mStats.buildMs = Milliseconds(start);
+        start = std::chrono::steady_clock::now();
+        this->QueryGrid(bodies);
+    }
+    this->GatherPairs();
+    this->mStats.pairMs = Milliseconds(start);
+
+    start = std::chrono::steady_clock::now();
+    this->Narrowphase(bodies);
+    this->mStats.narrowMs = Milliseconds(start);
+    this->mStats.candidates = this->mCandidates.size();
+    this->mStats.contacts = this->mContacts.size();
+}
+
+// sweeps along the widest axis; AUTO estimates the overlaps per body along it assuming a uniform spread
+Broadphase Collision::Choose(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    size_t chunks = this->mPool.Size() * 4;
+    size_t grain = std::max<size_t>((n + chunks - 1) / chunks, 1);
+    std::vector<float> partial(chunks * 7, 0.0f);
+
+    this->mPool.ParallelFor(n, grain, [&](size_t begin, size_t end) {
+        float lo[3] = { INFINITY, INFINITY, INFINITY };
+        float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+        float radius = 0.0f;
+        for (size_t i = begin; i < end; ++i)
+        {
+            lo[0] = std::min(lo[0], bodies.x[i]); hi[0] = std::max(hi[0], bodies.x[i]);
+            lo[1] = std::min(lo[1], bodies.y[i]); hi[1] = std::max(hi[1], bodies.y[i]);
+            lo[2] = std::min(lo[2], bodies.z[i]); hi[2] = std::max(hi[2], bodies.z[i]);
+            radius += bodies.radius[i];
+        }
+        float *out = &partial[(begin / grain) * 7];
+        for (int k = 0; k < 3; ++k)
+        {
+            out[k] = lo[k];
+            out[3 + k] = hi[k];
+        }
+        out[6] = radius;
+    });
+
+    float lo[3] = { INFINITY, INFINITY, INFINITY };
+    float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    double radius = 0.0;
+    for (size_t c = 0; c * grain < n; ++c)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            lo[k] = std::min(lo[k], partial[c*7 + k]);
+            hi[k] = std::max(hi[k], partial[c*7 + 3 + k]);
+        }
+        radius += partial[c*7 + 6];
+    }
+    this->mMeanRadius = n > 0 ? float(radius / double(n)) : 0.0f;
+
+    this->mAxis = 0;
+    for (int k = 1; k < 3; ++k)
+        if (hi[k] - lo[k] > hi[this->mAxis] - lo[this->mAxis])
+            this->mAxis = k;
+
+    if (this->mBroadphase != Broadphase::AUTO)
+        return this->mBroadphase;
+    float extent = std::max(hi[this->mAxis] - lo[this->mAxis], 1e-6f);
+    float overlaps = float(n) * 4.0f * this->mMeanRadius / extent;
+    return overlaps > SWEEP_OVERLAP_LIMIT ? Broadphase::HASH : Broadphase::SWEEP;
+}
+
+void Collision::SortIntervals(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    const float *axis = this->mAxis == 0 ? bodies.x.data() : this->mAxis == 1 ? bodies.y.data() : bodies.z.data();
+    this->mIntervals.resize(n);
+    this->mPool.ParallelFor(n, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            this->mIntervals[i] = { axis[i] - bodies.radius[i], axis[i] + bodies.radius[i], uint32_t(i) };
+    });
+    // frame to frame the order barely changes, but a fresh sort keeps the worst case bounded
+    ParallelSort(this->mPool, this->mIntervals);
+}
+
+void Collision::Sweep(const Bodies &bodies) {
+    size_t n = this->mIntervals.size();
+    size_t grain = std::max<size_t>(n / (this->mPool.Size() * 8), 256);
+    this->mChunkPairs.resize((n + grain - 1) / grain);
+
+    this->mPool.ParallelFor(n, grain, [&](size_t begin, size_t end) {
+        std::vector<Pair> &pairs = this->mChunkPairs[begin / grain];
+        pairs.clear();
+        for (size_t i = begin; i < end; ++i)
+        {
+            const Interval &a = this->mIntervals[i];
+            for (size_t j = i + 1; j < n && this->mIntervals[j].min <= a.max; ++j)
+            {
+                uint32_t b = this->mIntervals[j].index;
+                if (BoxesOverlap(bodies, a.index, b))
+                    pairs.emplace_back(std::min(a.index, b), std::max(a.index, b));
+            }
+        }
+    });
+}
+
+// bodies go to the cell of their centre; cells are twice the largest small radius wide, so touching
+// small bodies are always in neighbouring cells
+void Collision::BuildGrid(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    float largeRadius = HASH_LARGE_FACTOR * this->mMeanRadius;
+    float maxRadius = 0.0f;
+    this->mLarge.clear();
+    this->mIsLarge.assign(n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (bodies.radius[i] > largeRadius) {
+            this->mLarge.push_back(uint32_t(i));
+            this->mIsLarge[i] = 1;
+        } else {
+            maxRadius = std::max(maxRadius, bodies.radius[i]);
+        }
+    }
+    this->mCellSize = std::max(2.0f * maxRadius, 1e-6f);
+
+    size_t buckets = 1;
+    while (buckets < 2 * n)
+        buckets *= 2;
+    uint32_t mask = uint32_t(buckets - 1);
+
+    float inv = 1.0f / this->mCellSize;
+    this->mCells.resize(n);
+    this->mPool.ParallelFor(n, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            this->mCells[i] = { int(std::floor(bodies.x[i] * inv)), int(std::floor(bodies.y[i] * inv)),
+                                int(std::floor(bodies.z[i] * inv)), uint32_t(i) };
+    });
+
+    // counting sort by bucket
+    this->mBucketStart.assign(buckets + 1, 0);
+    for (const CellEntry &cell : this->mCells)
+        if (!this->mIsLarge[cell.index])
+            ++this->mBucketStart[(CellHash(cell.x, cell.y, cell.z) & mask) + 1];
+    for (size_t b = 0; b < buckets; ++b)
+        this->mBucketStart[b + 1] += this->mBucketStart[b];
+    this->mEntries.resize(this->mBucketStart[buckets]);
+    std::vector<uint32_t> fill(this->mBucketStart.begin(), this->mBucketStart.end() - 1);
+    for (const CellEntry &cell : this->mCells)
+        if (!this->mIsLarge[cell.index])
+            this->mEntries[fill[CellHash(cell.x, cell.y, cell.z) & mask]++] = cell;
+}
+
+// the same cell and the 13 neighbours that come after it, so each pair of cells is visited once
+static const int HALF_SHELL[14][3] = {
+        { 0, 0, 0 }, { 1, 0, 0 }, { -1, 1, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+        { -1, -1, 1 }, { 0, -1, 1 }, { 1, -1, 1 }, { -1, 0, 1 }, { 0, 0, 1 },
+        { 1, 0, 1 }, { -1, 1, 1 }, { 0, 1, 1 }, { 1, 1, 1 } };
+
+void Collision::QueryGrid(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    size_t entries = this->mEntries.size();
+    uint32_t mask = uint32_t(this->mBucketStart.size() - 2);
+    size_t grain = std::max<size_t>(n / (this->mPool.Size() * 8), 256);
+    this->mChunkPairs.resize((n + grain - 1) / grain);
+
+    this->mPool.ParallelFor(n, grain, [&](size_t begin, size_t end) {
+        std::vector<Pair> &pairs = this->mChunkPairs[begin / grain];
+        pairs.clear();
+        for (size_t k = begin; k < end; ++k)
+        {
+            // grid bodies are walked in bucket order, the bodies of one cell are next to each other
+            if (k < entries) {
+                const CellEntry &cell = this->mEntries[k];
+                for (const int *offset : HALF_SHELL)
+                {
+                    int x = cell.x + offset[0], y = cell.y + offset[1], z = cell.z + offset[2];
+                    bool same = offset == HALF_SHELL[0];
+                    uint32_t bucket = CellHash(x, y, z) & mask;
+                    for (uint32_t e = this->mBucketStart[bucket]; e < this->mBucketStart[bucket + 1]; ++e)
+                    {
+                        const CellEntry &other = this->mEntries[e];
+                        // buckets are shared by colliding hashes, the cell check keeps pairs unique
+                        if ((!same || other.index > cell.index) && other.x == x && other.y == y && other.z == z
+                            && BoxesOverlap(bodies, cell.index, other.index))
+                            pairs.emplace_back(std::min(cell.index, other.index), std::max(cell.index, other.index));
+                    }
+                }
+            }
+            // large bodies against everything, each pair reported once
+            for (uint32_t large : this->mLarge)
+            {
+                uint32_t i = uint32_t(k);
+                if (large == i || (this->mIsLarge[i] && large < i))
+                    continue;
+                if (BoxesOverlap(bodies, i, large))
+                    pairs.emplace_back(std::min(i, large), std::max(i, large));
+            }
+        }
+    });
+}
+
+void Collision::GatherPairs() {
+    size_t total = 0;
+    for (const std::vector<Pair> &pairs : this->mChunkPairs)
+        total += pairs.size();
+    this->mCandidates.clear();
+    this->mCandidates.reserve(total);
+    for (const std::vector<Pair> &pairs : this->mChunkPairs)
+        this->mCandidates.insert(this->mCandidates.end(), pairs.begin(), pairs.end());
+}
+
+void Collision::Narrowphase(const Bodies &bodies) {
+    size_t n = this->mCandidates.size();
+    size_t grain = std::max<size_t>(n / (this->mPool.Size() * 4), 1024);
+    this->mChunkContacts.resize((n + grain - 1) / grain);
+
+    this->mPool.ParallelFor(n, grain, [&](size_t begin, size_t end) {
+        std::vector<Contact> &contacts = this->mChunkContacts[begin / grain];
+        contacts.clear();
+        for (size_t p = begin; p < end; ++p)
+        {
+            uint32_t a = this->mCandidates[p].first, b = this->mCandidates[p].second;
+            float dx = bodies.x[b] - bodies.x[a], dy = bodies.y[b] - bodies.y[a], dz = bodies.z[b] - bodies.z[a];
+            float r = bodies.radius[a] + bodies.radius[b];
+            float d2 = dx*dx + dy*dy + dz*dz;
+            if (d2 < r * r)
+                contacts.push_back({ a, b, r - std::sqrt(d2) });
+        }
+    });
+
+    this->mContacts.clear();
+    for (size_t c = 0; c * grain < n; ++c)
+        this->mContacts.insert(this->mContacts.end(), this->mChunkContacts[c].begin(), this->mChunkContacts[c].end());
+}
+
+void Collision::Resolve(Bodies &bodies, float restitution) const {
+    for (const Contact &contact : this->mContacts)
+    {
+        uint32_t a = contact.a, b = contact.b;
+        glm::vec3 d = bodies.Position(b) - bodies.Position(a);
+        float length = glm::length(d);
+        glm::vec3 normal = length > 0.0f ? d / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        float wa = 1.0f / bodies.mass[a], wb = 1.0f / bodies.mass[b];
+
+        // split the overlap by inverse mass
+        glm::vec3 push = normal * (contact.depth / (wa + wb));
+        bodies.x[a] -= push.x * wa; bodies.y[a] -= push.y * wa; bodies.z[a] -= push.z * wa;
+        bodies.x[b] += push.x * wb; bodies.y[b] += push.y * wb; bodies.z[b] += push.z * wb;
+
+        float approach = glm::dot(bodies.Velocity(b) - bodies.Velocity(a), normal);
+        if (approach >= 0.0f)
+            continue;
+        glm::vec3 impulse = normal * (-(1.0f + restitution) * approach / (wa + wb));
+        bodies.vx[a] -= impulse.x * wa; bodies.vy[a] -= impulse.y * wa; bodies.vz[a] -= impulse.z * wa;
+        bodies.vx[b] += impulse.x * wb; bodies.vy[b] += impulse.y * wb; bodies.vz[b] += impulse.z * wb;
+    }
+}
@@ -0,0 +1,107 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_COLLISION_H
+#define PROJECT_COLLISION_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Bodies.h"
+#include "ThreadPool.h"
+
+// AUTO hashes when a body would overlap more than this many others on the sweep axis
+#define SWEEP_OVERLAP_LIMIT 16
+// bodies this many times larger than the mean radius skip the grid and are tested against everyone
+#define HASH_LARGE_FACTOR 8.0f
+
+enum class Broadphase
+{
+    AUTO, SWEEP, HASH
+};
+
+const char *BroadphaseName(Broadphase broadphase);
+
+// two touching bodies, a < b
+struct Contact
+{
+    uint32_t a, b;
+    float depth;
+};
+
+
+// broadphase over the bounding spheres of Bodies::radius, then the exact sphere-sphere test
+class Collision {
+public:
+    typedef std::pair<uint32_t, uint32_t> Pair;
+
+    struct Stats
+    {
+        Broadphase broadphase;            // what AUTO resolved to
+        size_t candidates;                // pairs with overlapping boxes
+        size_t contacts;
+        double buildMs;                   // bounds and the sort or the grid
+        double pairMs;                    // sweep or grid queries
+        double narrowMs;
+    };
+private:
+    struct Interval
+    {
+        float min, max;
+        uint32_t index;
+        inline bool operator<(const Interval &other) const { return this->min < other.min; }
+    };
+    struct CellEntry
+    {
+        int x, y, z;
+        uint32_t index;
+    };
+
+    ThreadPool &mPool;
+    Broadphase mBroadphase;
+    Stats mStats{};
+    float mMeanRadius = 0.0f;
+
+    // sweep
+    int mAxis = 0;
+    std::vector<Interval> mIntervals;
+    // hash
+    float mCellSize = 1.0f;
+    std::vector<CellEntry> mCells;           // per body, then sorted by bucket into mEntries
+    std::vector<CellEntry> mEntries;
+    std::vector<uint32_t> mBucketStart;
+    std::vector<uint32_t> mLarge;
+    std::vector<char> mIsLarge;
+
+    // per chunk outputs, concatenated in chunk order so results do not depend on the thread count
+    std::vector<std::vector<Pair>> mChunkPairs;
+    std::vector<std::vector<Contact>> mChunkContacts;
+    std::vector<Pair> mCandidates;
+    std::vector<Contact> mContacts;
+
+    Broadphase Choose(const Bodies &bodies);
+    void SortIntervals(const Bodies &bodies);
+    void Sweep(const Bodies &bodies);
+    void BuildGrid(const Bodies &bodies);
+    void QueryGrid(const Bodies &bodies);
+    void Narrowphase(const Bodies &bodies);
+    void GatherPairs();
+public:
+    explicit Collision(ThreadPool &pool, Broadphase broadphase = Broadphase::AUTO);
+    ~Collision();
+
+    inline void setBroadphase(Broadphase broadphase) { this->mBroadphase = broadphase; }
+    inline Broadphase getBroadphase() const { return this->mBroadphase; }
+    inline const std::vector<Pair> &getCandidates() const { return this->mCandidates; }
+    inline const std::vector<Contact> &getContacts() const { return this->mContacts; }
+    inline const Stats &getStats() const { return this->mStats; }
+
+    // candidate pairs for the current positions and the contacts among them
+    void Detect(const Bodies &bodies);
+    // pushes the last contacts apart and removes their approach speed, restitution in [0, 1]
+    void Resolve(Bodies &bodies, float restitution) const;
+};
+
+
+#endif //PROJECT_COLLISION_H
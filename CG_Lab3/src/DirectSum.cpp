@@ -0,0 +1,132 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "DirectSum.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+
+DirectSum::DirectSum(ThreadPool &pool, float softening) : mPool(pool), mSoftening(std::max(softening, 1e-6f)) {
+
+}
+
+DirectSum::~DirectSum() {
+
+}
+
+bool DirectSum::HasAVX2() {
+    return CpuHasAVX2();
+}
+
+void DirectSum::Pack(const Bodies &bodies) {
+    size_t n = bodies.Size();
+    size_t padded = (n + 7) & ~size_t(7);
+
+    this->mX.assign(padded, 0.0f);
+    this->mY.assign(padded, 0.0f);
+    this->mZ.assign(padded, 0.0f);
+    this->mMass.assign(padded, 0.0f);
+    this->mAX.assign(padded, 0.0f);
+    this->mAY.assign(padded, 0.0f);
+    this->mAZ.assign(padded, 0.0f);
+    std::copy(bodies.x.begin(), bodies.x.end(), this->mX.begin());
+    std::copy(bodies.y.begin(), bodies.y.end(), this->mY.begin());
+    std::copy(bodies.z.begin(), bodies.z.end(), this->mZ.begin());
+    std::copy(bodies.mass.begin(), bodies.mass.end(), this->mMass.begin());
+}
+
+// reference path, also used on CPUs without AVX2
+void DirectSum::ScalarRange(size_t begin, size_t end) {
+    const size_t n = this->mX.size();
+    const float eps2 = this->mSoftening * this->mSoftening;
+
+    for (size_t tile = 0; tile < n; tile += DIRECT_SUM_TILE)
+    {
+        size_t tileEnd = std::min(tile + DIRECT_SUM_TILE, n);
+        for (size_t i = begin; i < end; ++i)
+        {
+            float px = this->mX[i], py = this->mY[i], pz = this->mZ[i];
+            float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+            for (size_t j = tile; j < tileEnd; ++j)
+            {
+                float dx = this->mX[j] - px, dy = this->mY[j] - py, dz = this->mZ[j] - pz;
+                float d2 = dx*dx + dy*dy + dz*dz + eps2;
+                float inv = 1.0f / std::sqrt(d2);
+                float s = this->mMass[j] * inv * inv * inv;
+                sx += dx * s; sy += dy * s; sz += dz * s;
+            }
+            this->mAX[i] += sx;
+            this->mAY[i] += sy;
+            this->mAZ[i] += sz;
+        }
+    }
+}
+
+// eight targets per register, sources broadcast one by one from the current tile
+__attribute__((target("avx2,fma")))
+void DirectSum::AVX2Range(size_t begin, size_t end) {
+    const size_t n = this->mX.size();
+    const __m256 eps2 = _mm256_set1_ps(this->mSoftening * this->mSoftening);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const float *X = this->mX.data(), *Y = this->mY.data(), *Z = this->mZ.data(), *M = this->mMass.data();
+
+    for (size_t tile = 0; tile < n; tile += DIRECT_SUM_TILE)
+    {
+        size_t tileEnd = std::min(tile + DIRECT_SUM_TILE, n);
+        for (size_t i = begin; i < end; i += 8)
+        {
+            __m256 px = _mm256_loadu_ps(X + i), py = _mm256_loadu_ps(Y + i), pz = _mm256_loadu_ps(Z + i);
+            __m256 sx = _mm256_setzero_ps(), sy = _mm256_setzero_ps(), sz = _mm256_setzero_ps();
+            for (size_t j = tile; j < tileEnd; ++j)
+            {
+                __m256 dx = _mm256_sub_ps(_mm256_broadcast_ss(X + j), px);
+                __m256 dy = _mm256_sub_ps(_mm256_broadcast_ss(Y + j), py);
+                __m256 dz = _mm256_sub_ps(_mm256_broadcast_ss(Z + j), pz);
+                __m256 d2 = _mm256_fmadd_ps(dx, dx, eps2);
+                d2 = _mm256_fmadd_ps(dy, dy, d2);
+                d2 = _mm256_fmadd_ps(dz, dz, d2);
+
+                // 12 bit estimate refined by one Newton step: y * (1.5 - 0.5 * d2 * y * y)
+                __m256 inv = _mm256_rsqrt_ps(d2);
+                __m256 hy = _mm256_mul_ps(_mm256_mul_ps(half, d2), inv);
+                inv = _mm256_mul_ps(inv, _mm256_fnmadd_ps(hy, inv, threeHalves));
+
+                __m256 s = _mm256_mul_ps(_mm256_mul_ps(inv, inv), _mm256_mul_ps(inv, _mm256_broadcast_ss(M + j)));
+                sx = _mm256_fmadd_ps(dx, s, sx);
+                sy = _mm256_fmadd_ps(dy, s, sy);
+                sz = _mm256_fmadd_ps(dz, s, sz);
+            }
+            _mm256_storeu_ps(&this->mAX[i], _mm256_add_ps(_mm256_loadu_ps(&this->mAX[i]), sx));
+            _mm256_storeu_ps(&this->mAY[i], _mm256_add_ps(_mm256_loadu_ps(&this->mAY[i]), sy));
+            _mm256_storeu_ps(&this->mAZ[i], _mm256_add_ps(_mm256_loadu_ps(&this->mAZ[i]), sz));
+        }
+    }
+}
+
+void DirectSum::ComputeAccelerations(Bodies &bodies, Path path) {
+    if (bodies.Size() == 0)
+        return;
+    if (path == Path::AVX2 && !HasAVX2())
+        path = Path::SCALAR;
+
+    this->Pack(bodies);
+    // chunks are multiples of 8 so that every vector stays inside one thread
+    size_t groups = this->mX.size() / 8;
+    this->mPool.ParallelFor(groups, 8, [&](size_t begin, size_t end) {
+        if (path == Path::AVX2)
+            this->AVX2Range(begin * 8, end * 8);
+        else
+            this->ScalarRange(begin * 8, end * 8);
+    });
+
+    for (size_t i = 0; i < bodies.Size(); ++i)
+    {
+        bodies.ax[i] = GRAVITY * this->mAX[i];
+        bodies.ay[i] = GRAVITY * this->mAY[i];
+        bodies.az[i] = GRAVITY * this->mAZ[i];
+    }
+}
@@ -0,0 +1,45 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_DIRECTSUM_H
+#define PROJECT_DIRECTSUM_H
+
+#include <vector>
+#include "Bodies.h"
+#include "ThreadPool.h"
+
+// bodies per cache tile of the source loop: 4 arrays * 1024 floats = 16 KiB
+#define DIRECT_SUM_TILE 1024
+
+
+// exact O(N^2) gravity, faster than the tree for a few thousand bodies
+class DirectSum {
+public:
+    enum class Path
+    {
+        SCALAR, AVX2
+    };
+private:
+    ThreadPool &mPool;
+    float mSoftening;
+    // positions and masses padded to a multiple of 8 with massless bodies
+    std::vector<float> mX, mY, mZ, mMass;
+    std::vector<float> mAX, mAY, mAZ;
+
+    void Pack(const Bodies &bodies);
+    void ScalarRange(size_t begin, size_t end);
+    void AVX2Range(size_t begin, size_t end);
+public:
+    // softening has to be positive, self interaction then contributes exactly zero
+    explicit DirectSum(ThreadPool &pool, float softening = SOFTENING);
+    ~DirectSum();
+
+    // true if the CPU executing us has AVX2 and FMA
+    static bool HasAVX2();
+
+    void ComputeAccelerations(Bodies &bodies, Path path);
+};
+
+
+#endif //PROJECT_DIRECTSUM_H
@@ -0,0 +1,317 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Ephemeris.h"
+#include "Hash.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PI_D 3.141592653589793
+
+Ephemeris::Ephemeris() {
+
+}
+
+Ephemeris::~Ephemeris() {
+    this->Close();
+}
+
+bool Ephemeris::Open(const std::string &path) {
+    this->Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Failed to open ephemeris " << path << std::endl;
+        return false;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(EphemerisHeader)) {
+        std::cout << "Ephemeris " << path << " is too short" << std::endl;
+        close(fd);
+        return false;
+    }
+    size_t size = size_t(info.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cout << "Failed to map ephemeris " << path << std::endl;
+        return false;
+    }
+
+    const auto *header = static_cast<const EphemerisHeader *>(mapping);
+    uint64_t boundsEnd = sizeof(EphemerisHeader) + (uint64_t(header->segmentCount) + 1) * sizeof(double);
+    uint64_t coefficientsSize = uint64_t(header->segmentCount) * 3 * header->coefficientCount * header->stride * sizeof(float);
+    bool valid = std::memcmp(header->magic, EPHEMERIS_MAGIC, 4) == 0 && header->version == EPHEMERIS_VERSION
+            && header->segmentCount > 0 && header->coefficientCount > 0
+            && header->stride >= header->bodyCount && header->stride % 8 == 0
+            && header->coefficientOffset % 32 == 0 && header->coefficientOffset >= boundsEnd
+            && header->coefficientOffset + coefficientsSize <= size;
+    if (!valid) {
+        std::cout << "Ephemeris " << path << " has a wrong header" << std::endl;
+        munmap(mapping, size);
+        return false;
+    }
+
+    this->mMapping = mapping;
+    this->mMappingSize = size;
+    this->mHeader = header;
+    this->mBounds = reinterpret_cast<const double *>(static_cast<const char *>(mapping) + sizeof(EphemerisHeader));
+    this->mCoefficients = reinterpret_cast<const float *>(static_cast<const char *>(mapping) + header->coefficientOffset);
+    // segments are read in time order while the simulation runs
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void Ephemeris::Close() {
+    if (this->mMapping != nullptr)
+        munmap(this->mMapping, this->mMappingSize);
+    this->mMapping = nullptr;
+    this->mMappingSize = 0;
+    this->mHeader = nullptr;
+    this->mBounds = nullptr;
+    this->mCoefficients = nullptr;
+}
+
+size_t Ephemeris::Segment(double t) const {
+    size_t count = this->mHeader->segmentCount;
+    // first bound greater than t, the segment starts one before it
+    const double *upper = std::upper_bound(this->mBounds + 1, this->mBounds + count, t);
+    return size_t(upper - (this->mBounds + 1));
+}
+
+// Clenshaw recurrence, b_k = c_k + 2 tau b_(k+1) - b_(k+2), p = c_0 + tau b_1 - b_2
+void Ephemeris::ScalarRange(const float *segment, float tau, size_t begin, size_t end,
+                            float *x, float *y, float *z) const {
+    const size_t n = this->mHeader->coefficientCount, stride = this->mHeader->stride;
+    float *out[3] = { x, y, z };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float *c = segment + axis * n * stride;
+        for (size_t i = begin; i < end; ++i)
+        {
+            float b1 = 0.0f, b2 = 0.0f;
+            for (size_t k = n - 1; k >= 1; --k)
+            {
+                float b = c[k * stride + i] + 2.0f * tau * b1 - b2;
+                b2 = b1;
+                b1 = b;
+            }
+            out[axis][i] = c[i] + tau * b1 - b2;
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void Ephemeris::AVX2Range(const float *segment, float tau, size_t begin, size_t end,
+                          float *x, float *y, float *z) const {
+    const size_t n = this->mHeader->coefficientCount, stride = this->mHeader->stride;
+    const __m256 t = _mm256_set1_ps(tau);
+    const __m256 t2 = _mm256_set1_ps(2.0f * tau);
+    float *out[3] = { x, y, z };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float *c = segment + axis * n * stride;
+        for (size_t i = begin; i + 8 <= end; i += 8)
+        {
+            __m256 b1 = _mm256_setzero_ps(), b2 = _mm256_setzero_ps();
+            for (size_t k = n - 1; k >= 1; --k)
+            {
+                // rows are 32 byte aligned: the offset and the stride are multiples of 8 floats
+                __m256 b = _mm256_fmadd_ps(t2, b1, _mm256_sub_ps(_mm256_load_ps(c + k * stride + i), b2));
+                b2 = b1;
+                b1 = b;
+            }
+            _mm256_storeu_ps(out[axis] + i, _mm256_fmadd_ps(t, b1, _mm256_sub_ps(_mm256_load_ps(c + i), b2)));
+        }
+    }
+}
+
+const float *Ephemeris::Locate(double t, float &tau) const {
+    size_t s = this->Segment(t);
+    double a = this->mBounds[s], b = this->mBounds[s + 1];
+    // segment time mapped to [-1, 1], clamped outside the table
+    tau = float(std::max(-1.0, std::min(1.0, (2.0 * t - a - b) / (b - a))));
+    return this->mCoefficients + s * 3 * this->mHeader->coefficientCount * this->mHeader->stride;
+}
+
+void Ephemeris::Evaluate(double t, float *x, float *y, float *z, Path path) const {
+    float tau;
+    const float *segment = this->Locate(t, tau);
+
+    size_t count = this->mHeader->bodyCount;
+    size_t vectorEnd = 0;
+    if (path == Path::AVX2 && CpuHasAVX2())
+    {
+        vectorEnd = count & ~size_t(7);
+        this->AVX2Range(segment, tau, 0, vectorEnd, x, y, z);
+    }
+    this->ScalarRange(segment, tau, vectorEnd, count, x, y, z);
+}
+
+void Ephemeris::Evaluate(double t, Bodies &bodies, size_t first, const glm::vec3 &focus, Path path) const {
+    float *x = &bodies.x[first], *y = &bodies.y[first], *z = &bodies.z[first];
+    this->Evaluate(t, x, y, z, path);
+    for (size_t i = 0; i < this->mHeader->bodyCount; ++i)
+    {
+        x[i] += focus.x;
+        y[i] += focus.y;
+        z[i] += focus.z;
+    }
+}
+
+void Ephemeris::ScalarGather(const uint32_t *bodies, const double *t, size_t begin, size_t end,
+                             float *x, float *y, float *z) const {
+    const size_t n = this->mHeader->coefficientCount, stride = this->mHeader->stride;
+    float *out[3] = { x, y, z };
+    for (size_t j = begin; j < end; ++j)
+    {
+        float tau;
+        const float *segment = this->Locate(t[j], tau);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float *c = segment + axis * n * stride + bodies[j];
+            float b1 = 0.0f, b2 = 0.0f;
+            for (size_t k = n - 1; k >= 1; --k)
+            {
+                float b = c[k * stride] + 2.0f * tau * b1 - b2;
+                b2 = b1;
+                b1 = b;
+            }
+            out[axis][j] = c[0] + tau * b1 - b2;
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void Ephemeris::AVX2Gather(const uint32_t *bodies, const double *t, size_t begin, size_t end,
+                           float *x, float *y, float *z) const {
+    const size_t n = this->mHeader->coefficientCount, stride = this->mHeader->stride;
+    float *out[3] = { x, y, z };
+    for (size_t j = begin; j + 8 <= end; j += 8)
+    {
+        // every lane in its own segment: the coefficients are gathered by offset from the table start
+        alignas(32) int32_t offset[8];
+        alignas(32) float tau[8];
+        for (int lane = 0; lane < 8; ++lane)
+            offset[lane] = int32_t(this->Locate(t[j + lane], tau[lane]) - this->mCoefficients) + int32_t(bodies[j + lane]);
+        const __m256i base = _mm256_load_si256(reinterpret_cast<const __m256i *>(offset));
+        const __m256 tv = _mm256_load_ps(tau);
+        const __m256 t2 = _mm256_add_ps(tv, tv);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            __m256 b1 = _mm256_setzero_ps(), b2 = _mm256_setzero_ps();
+            for (size_t k = n - 1; k >= 1; --k)
+            {
+                __m256i row = _mm256_add_epi32(base, _mm256_set1_epi32(int32_t((axis * n + k) * stride)));
+                __m256 b = _mm256_fmadd_ps(t2, b1, _mm256_sub_ps(_mm256_i32gather_ps(this->mCoefficients, row, 4), b2));
+                b2 = b1;
+                b1 = b;
+            }
+            __m256i row = _mm256_add_epi32(base, _mm256_set1_epi32(int32_t(axis * n * stride)));
+            _mm256_storeu_ps(out[axis] + j, _mm256_fmadd_ps(tv, b1, _mm256_sub_ps(_mm256_i32gather_ps(this->mCoefficients, row, 4), b2)));
+        }
+    }
+}
+
+void Ephemeris::Evaluate(const uint32_t *bodies, const double *t, size_t count, float *x, float *y, float *z,
+                         Path path) const {
+    // gather offsets are 32 bit
+    size_t table = size_t(this->mHeader->segmentCount) * 3 * this->mHeader->coefficientCount * this->mHeader->stride;
+    size_t vectorEnd = 0;
+    if (path == Path::AVX2 && CpuHasAVX2() && table <= size_t(INT32_MAX))
+    {
+        vectorEnd = count & ~size_t(7);
+        this->AVX2Gather(bodies, t, 0, vectorEnd, x, y, z);
+    }
+    this->ScalarGather(bodies, t, vectorEnd, count, x, y, z);
+}
+
+uint64_t Ephemeris::Key(uint64_t sourceKey, size_t coefficientCount, double begin, double end, size_t segmentCount)
+{
+    uint64_t counts[2] = { coefficientCount, segmentCount };
+    double span[2] = { begin, end };
+    uint64_t hash = Fnv1a(FNV1A_BASIS, &sourceKey, sizeof(sourceKey));
+    hash = Fnv1a(hash, counts, sizeof(counts));
+    return Fnv1a(hash, span, sizeof(span));
+}
+
+bool Ephemeris::Fit(const std::string &path, size_t bodyCount, size_t coefficientCount,
+                    double begin, double end, size_t segmentCount, uint64_t sourceKey, const Sampler &sample)
+{
+    const size_t n = coefficientCount;
+    const size_t stride = (bodyCount + 7) & ~size_t(7);
+
+    EphemerisHeader header{};
+    std::memcpy(header.magic, EPHEMERIS_MAGIC, 4);
+    header.version = EPHEMERIS_VERSION;
+    header.bodyCount = uint32_t(bodyCount);
+    header.stride = uint32_t(stride);
+    header.coefficientCount = uint32_t(n);
+    header.segmentCount = uint32_t(segmentCount);
+    uint64_t boundsEnd = sizeof(EphemerisHeader) + (segmentCount + 1) * sizeof(double);
+    header.coefficientOffset = (boundsEnd + 31) & ~uint64_t(31);
+    header.key = Key(sourceKey, coefficientCount, begin, end, segmentCount);
+
+    std::vector<double> bounds(segmentCount + 1);
+    for (size_t s = 0; s <= segmentCount; ++s)
+        bounds[s] = begin + (end - begin) * double(s) / double(segmentCount);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Failed to write ephemeris " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(bounds.data()), bounds.size() * sizeof(double));
+    std::vector<char> padding(header.coefficientOffset - boundsEnd, 0);
+    file.write(padding.data(), padding.size());
+
+    std::vector<float> x(bodyCount), y(bodyCount), z(bodyCount);
+    std::vector<double> samples(n * 3 * bodyCount);
+    std::vector<float> coefficients(3 * n * stride);
+    std::vector<double> basis(n * n);
+    for (size_t k = 0; k < n; ++k)
+        for (size_t j = 0; j < n; ++j)
+            basis[k * n + j] = std::cos(PI_D * k * (j + 0.5) / n) * (k == 0 ? 1.0 : 2.0) / n;
+    for (size_t s = 0; s < segmentCount; ++s)
+    {
+        double mid = 0.5 * (bounds[s] + bounds[s + 1]), half = 0.5 * (bounds[s + 1] - bounds[s]);
+        // samples at the nodes tau_j = cos(pi (j + 1/2) / n)
+        for (size_t j = 0; j < n; ++j)
+        {
+            sample(mid + half * std::cos(PI_D * (j + 0.5) / n), x.data(), y.data(), z.data());
+            for (size_t i = 0; i < bodyCount; ++i)
+            {
+                samples[(j * 3 + 0) * bodyCount + i] = x[i];
+                samples[(j * 3 + 1) * bodyCount + i] = y[i];
+                samples[(j * 3 + 2) * bodyCount + i] = z[i];
+            }
+        }
+        // c_k = 2/n sum_j f(tau_j) cos(pi k (j + 1/2) / n), c_0 halved
+        std::fill(coefficients.begin(), coefficients.end(), 0.0f);
+        for (size_t axis = 0; axis < 3; ++axis)
+            for (size_t k = 0; k < n; ++k)
+                for (size_t i = 0; i < bodyCount; ++i)
+                {
+                    double sum = 0.0;
+                    for (size_t j = 0; j < n; ++j)
+                        sum += samples[(j * 3 + axis) * bodyCount + i] * basis[k * n + j];
+                    coefficients[(axis * n + k) * stride + i] = float(sum);
+                }
+        file.write(reinterpret_cast<const char *>(coefficients.data()), coefficients.size() * sizeof(float));
+    }
+    return file.good();
+}
@@ -0,0 +1,96 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_EPHEMERIS_H
+#define PROJECT_EPHEMERIS_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <glm/glm.hpp>
+#include "Bodies.h"
+
+#define EPHEMERIS_MAGIC "EPHM"
+#define EPHEMERIS_VERSION 2
+
+// file layout, little endian:
+//   header
+//   double bounds[segmentCount + 1]                       segment i covers [bounds[i], bounds[i + 1])
+//   float coefficients[segmentCount][3][coefficientCount][stride]   at coefficientOffset, 32 byte aligned
+// a row holds one Chebyshev coefficient of one axis for every body, padded to a multiple of 8
+struct EphemerisHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t bodyCount;
+    uint32_t stride;
+    uint32_t coefficientCount;
+    uint32_t segmentCount;
+    uint64_t coefficientOffset;
+    uint64_t key;                   // Ephemeris::Key of what the table was fitted from
+};
+
+
+// Chebyshev ephemeris segments read straight from a memory-mapped file
+class Ephemeris {
+public:
+    enum class Path
+    {
+        SCALAR, AVX2
+    };
+    // writes positions of all bodies at time t into x/y/z
+    typedef std::function<void(double t, float *x, float *y, float *z)> Sampler;
+private:
+    void *mMapping = nullptr;
+    size_t mMappingSize = 0;
+    const EphemerisHeader *mHeader = nullptr;
+    const double *mBounds = nullptr;
+    const float *mCoefficients = nullptr;
+
+    // coefficients of the segment holding t and t mapped into it
+    const float *Locate(double t, float &tau) const;
+    void ScalarRange(const float *segment, float tau, size_t begin, size_t end, float *x, float *y, float *z) const;
+    void AVX2Range(const float *segment, float tau, size_t begin, size_t end, float *x, float *y, float *z) const;
+    void ScalarGather(const uint32_t *bodies, const double *t, size_t begin, size_t end, float *x, float *y, float *z) const;
+    void AVX2Gather(const uint32_t *bodies, const double *t, size_t begin, size_t end, float *x, float *y, float *z) const;
+public:
+    Ephemeris();
+    ~Ephemeris();
+    Ephemeris(const Ephemeris &) = delete;
+    Ephemeris &operator=(const Ephemeris &) = delete;
+
+    // maps the file read-only, false and a message if it is missing or malformed
+    bool Open(const std::string &path);
+    void Close();
+
+    inline bool IsOpen() const { return this->mHeader != nullptr; }
+    inline size_t getBodyCount() const { return this->mHeader ? this->mHeader->bodyCount : 0; }
+    inline size_t getSegmentCount() const { return this->mHeader ? this->mHeader->segmentCount : 0; }
+    inline uint64_t getKey() const { return this->mHeader ? this->mHeader->key : 0; }
+    inline double getBegin() const { return this->mBounds ? this->mBounds[0] : 0.0; }
+    inline double getEnd() const { return this->mBounds ? this->mBounds[this->mHeader->segmentCount] : 0.0; }
+    inline bool Covers(double t) const { return this->IsOpen() && t >= this->getBegin() && t <= this->getEnd(); }
+
+    // index of the segment holding t by binary search over the bounds, clamped to the table
+    size_t Segment(double t) const;
+    // positions of all bodies at t into x/y/z[0 .. getBodyCount())
+    void Evaluate(double t, float *x, float *y, float *z, Path path = Path::AVX2) const;
+    // positions of bodies [first, first + getBodyCount()) around focus
+    void Evaluate(double t, Bodies &bodies, size_t first, const glm::vec3 &focus, Path path = Path::AVX2) const;
+    // positions of bodies[0 .. count), each at its own time t[k], into x/y/z[0 .. count); for scattered
+    // bodies such as those a staggered update has due
+    void Evaluate(const uint32_t *bodies, const double *t, size_t count, float *x, float *y, float *z,
+                  Path path = Path::AVX2) const;
+
+    // hash of the sampled source (e.g. KeplerOrbits::Key) and the fit parameters; a table whose key
+    // differs was fitted from something else and has to be fitted again
+    static uint64_t Key(uint64_t sourceKey, size_t coefficientCount, double begin, double end, size_t segmentCount);
+    // fits coefficientCount Chebyshev terms per axis on segmentCount equal segments of [begin, end]
+    // by sampling at the Chebyshev nodes, and writes the table to path under Key(sourceKey, ...)
+    static bool Fit(const std::string &path, size_t bodyCount, size_t coefficientCount,
+                    double begin, double end, size_t segmentCount, uint64_t sourceKey, const Sampler &sample);
+};
+
+
+#endif //PROJECT_EPHEMERIS_H
@@ -0,0 +1,75 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "ErrorChecker.h"
+
+#include <execinfo.h>
+#include <unistd.h>
+
+#define DEBUG_STACK_DEPTH 32
+
+static const char *DebugSource(GLenum source)
+{
+    switch (source) {
+        case GL_DEBUG_SOURCE_API: return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        default: return "other";
+    }
+}
+
+static const char *DebugType(GLenum type)
+{
+    switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        default: return "other";
+    }
+}
+
+static const char *DebugSeverity(GLenum severity)
+{
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        case GL_DEBUG_SEVERITY_LOW: return "low";
+        default: return "notification";
+    }
+}
+
+static void APIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                   const GLchar *message, const void *userParam)
+{
+    std::cout << "[OpenGL " << DebugType(type) << "] " << DebugSource(source) << ", " << DebugSeverity(severity)
+              << ", id " << id << ": " << message << std::endl;
+    // errors only, performance hints would flood the output with stacks
+    if (type != GL_DEBUG_TYPE_ERROR)
+        return;
+    void *frames[DEBUG_STACK_DEPTH];
+    int depth = backtrace(frames, DEBUG_STACK_DEPTH);
+    // the first frames are this callback and the driver
+    backtrace_symbols_fd(frames, depth, STDOUT_FILENO);
+}
+
+bool EnableDebugOutput(bool synchronous)
+{
+    if (!GLAD_GL_VERSION_4_3 || glDebugMessageCallback == nullptr) {
+        std::cout << "Debug output needs OpenGL 4.3" << std::endl;
+        return false;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(DebugCallback, nullptr);
+    // notifications (buffer placement and the like) are not worth a line each
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    return true;
+}
@@ -10,16 +10,39 @@
 #include <iostream>
 #define ASSERT(x) if (!(x)) __builtin_trap()
 
+// how GLCall reports errors, chosen at compile time:
+//   OFF       the call alone, no driver round trips (release)
+//   CHECK     glGetError drained before and checked after every call (debug)
+//   CALLBACK  the call alone, errors come from the driver's debug output (EnableDebugOutput)
+#define GL_ERRORS_OFF 0
+#define GL_ERRORS_CHECK 1
+#define GL_ERRORS_CALLBACK 2
+#ifndef GL_ERROR_POLICY
+#ifdef NDEBUG
+#define GL_ERROR_POLICY GL_ERRORS_OFF
+#else
+#define GL_ERROR_POLICY GL_ERRORS_CHECK
+#endif
+#endif
+
+#if GL_ERROR_POLICY == GL_ERRORS_CHECK
 #define GLCall(x) GLClearError();\
     x;\
     ASSERT(GLCheckError())
+#else
+#define GLCall(x) x
+#endif
+
+// GL_DEBUG_OUTPUT callback printing source, type, severity, the message and the stack of the calling
+// thread; synchronous output makes that stack the one of the failing call. needs OpenGL 4.3
+bool EnableDebugOutput(bool synchronous);
 
-static void GLClearError()
+static inline void GLClearError()
 {
     while (glGetError() != GL_NO_ERROR);
 }
 
-static bool GLCheckError()
+static inline bool GLCheckError()
 {
     while (GLenum error = glGetError())
     {
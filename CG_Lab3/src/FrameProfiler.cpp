@@ -0,0 +1,113 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include <glad/glad.h>
+#include "FrameProfiler.h"
+#include "ErrorChecker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+FrameProfiler::FrameProfiler() {
+    GLCall(glGenQueries(2 * FRAME_PROFILER_QUERIES, this->mQueries));
+}
+
+FrameProfiler::~FrameProfiler() {
+    glDeleteQueries(2 * FRAME_PROFILER_QUERIES, this->mQueries);
+}
+
+void FrameProfiler::Collect(size_t slot) {
+    if (!this->mActive[slot])
+        return;
+    GLuint64 begin = 0, end = 0;
+    GLCall(glGetQueryObjectui64v(this->mQueries[2 * slot], GL_QUERY_RESULT, &begin));
+    GLCall(glGetQueryObjectui64v(this->mQueries[2 * slot + 1], GL_QUERY_RESULT, &end));
+    this->mGpu[this->mPending[slot]] = double(end - begin) * 1e-6;
+    this->mActive[slot] = false;
+}
+
+void FrameProfiler::Begin() {
+    size_t slot = this->mFrame % FRAME_PROFILER_QUERIES;
+    this->Collect(slot);
+    this->mCpu.push_back(0.0);
+    this->mGpu.push_back(0.0);
+    this->mPending[slot] = this->mFrame;
+    this->mActive[slot] = true;
+    GLCall(glQueryCounter(this->mQueries[2 * slot], GL_TIMESTAMP));
+    this->mStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::End() {
+    this->mCpu[this->mFrame] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->mStart).count();
+    GLCall(glQueryCounter(this->mQueries[2 * (this->mFrame % FRAME_PROFILER_QUERIES) + 1], GL_TIMESTAMP));
+    ++this->mFrame;
+}
+
+void FrameProfiler::Finish() {
+    for (size_t slot = 0; slot < FRAME_PROFILER_QUERIES; ++slot)
+        this->Collect(slot);
+}
+
+FrameProfiler::Summary FrameProfiler::Summarize(const std::vector<double> &ms, size_t worst)
+{
+    Summary summary{};
+    if (ms.empty())
+        return summary;
+    std::vector<size_t> order(ms.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ms](size_t a, size_t b) { return ms[a] > ms[b]; });
+    // nearest rank on the descending order
+    auto Percentile = [&](double p) { return ms[order[std::min(ms.size() - 1, size_t((1.0 - p) * ms.size()))]]; };
+    summary.mean = std::accumulate(ms.begin(), ms.end(), 0.0) / ms.size();
+    summary.p50 = Percentile(0.5);
+    summary.p95 = Percentile(0.95);
+    summary.p99 = Percentile(0.99);
+    summary.max = ms[order.front()];
+    summary.worst.assign(order.begin(), order.begin() + std::min(worst, order.size()));
+    return summary;
+}
+
+void FrameProfiler::Print() const {
+    const char *names[2] = { "cpu", "gpu" };
+    const std::vector<double> *times[2] = { &this->mCpu, &this->mGpu };
+    std::printf("%zu frames\n%6s %10s %10s %10s %10s %10s   worst frames\n", this->mCpu.size(), "ms", "mean", "p50", "p95", "p99", "max");
+    for (int i = 0; i < 2; ++i)
+    {
+        Summary s = Summarize(*times[i]);
+        std::printf("%6s %10.3f %10.3f %10.3f %10.3f %10.3f  ", names[i], s.mean, s.p50, s.p95, s.p99, s.max);
+        for (size_t id : s.worst)
+            std::printf(" %zu", id);
+        std::printf("\n");
+    }
+}
+
+bool FrameProfiler::WriteJson(const std::string &path, const std::vector<std::pair<std::string, std::string>> &meta) const {
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        std::printf("Failed to write report %s\n", path.c_str());
+        return false;
+    }
+    std::fprintf(file, "{\n");
+    for (const auto &field : meta)
+        std::fprintf(file, "  \"%s\": %s,\n", field.first.c_str(), field.second.c_str());
+    std::fprintf(file, "  \"frames\": %zu", this->mCpu.size());
+
+    const char *names[2] = { "cpu", "gpu" };
+    const std::vector<double> *times[2] = { &this->mCpu, &this->mGpu };
+    for (int i = 0; i < 2; ++i)
+    {
+        Summary s = Summarize(*times[i]);
+        std::fprintf(file, ",\n  \"%s\": {\n    \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f,\n    \"worst\": [",
+                     names[i], s.mean, s.p50, s.p95, s.p99, s.max);
+        for (size_t k = 0; k < s.worst.size(); ++k)
+            std::fprintf(file, "%s%zu", k == 0 ? "" : ", ", s.worst[k]);
+        std::fprintf(file, "],\n    \"ms\": [");
+        for (size_t k = 0; k < times[i]->size(); ++k)
+            std::fprintf(file, "%s%.4f", k == 0 ? "" : ", ", (*times[i])[k]);
+        std::fprintf(file, "]\n  }");
+    }
+    std::fprintf(file, "\n}\n");
+    return std::fclose(file) == 0;
+}
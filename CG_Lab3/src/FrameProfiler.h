@@ -0,0 +1,54 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_FRAMEPROFILER_H
+#define PROJECT_FRAMEPROFILER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define FRAME_PROFILER_QUERIES 4
+
+// CPU time of every frame from Begin to End and its GPU time between two GL_TIMESTAMP queries
+// (unlike GL_TIME_ELAPSED they may overlap other queries). they are read FRAME_PROFILER_QUERIES
+// frames later, so waiting on them rarely stalls
+class FrameProfiler {
+public:
+    struct Summary
+    {
+        double mean, p50, p95, p99, max;
+        std::vector<size_t> worst;         // frame ids, slowest first
+    };
+private:
+    unsigned int mQueries[2 * FRAME_PROFILER_QUERIES] = {};      // begin and end of each frame
+    size_t mPending[FRAME_PROFILER_QUERIES] = {};
+    bool mActive[FRAME_PROFILER_QUERIES] = {};
+    std::vector<double> mCpu, mGpu;
+    std::chrono::steady_clock::time_point mStart;
+    size_t mFrame = 0;
+
+    void Collect(size_t slot);
+public:
+    FrameProfiler();
+    ~FrameProfiler();
+    FrameProfiler(const FrameProfiler &) = delete;
+    FrameProfiler &operator=(const FrameProfiler &) = delete;
+
+    void Begin();
+    void End();
+    // waits for the queries still in flight
+    void Finish();
+
+    static Summary Summarize(const std::vector<double> &ms, size_t worst = 5);
+    void Print() const;
+    // summaries and per-frame times, fields of meta are added as they are (already JSON)
+    bool WriteJson(const std::string &path, const std::vector<std::pair<std::string, std::string>> &meta) const;
+
+    inline const std::vector<double> &getCpu() const { return this->mCpu; }
+    inline const std::vector<double> &getGpu() const { return this->mGpu; }
+};
+
+
+#endif //PROJECT_FRAMEPROFILER_H
@@ -0,0 +1,227 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include <glad/glad.h>
+#include "GLIntercept.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#define GL_TRACE_BUFFER (1u << 20)
+
+enum GLFunctionId
+{
+#define GL_FUNCTION(name) GL_ID_##name,
+#include "GLFunctions.h"
+#undef GL_FUNCTION
+    GL_FUNCTION_COUNT
+};
+
+static const char *const NAMES[GL_FUNCTION_COUNT] = {
+#define GL_FUNCTION(name) #name,
+#include "GLFunctions.h"
+#undef GL_FUNCTION
+};
+
+struct Counter
+{
+    uint64_t calls;
+    uint64_t nanoseconds;
+};
+
+static bool enabled = false;
+static Counter counters[GL_FUNCTION_COUNT];
+static GLIntercept::Category categories[GL_FUNCTION_COUNT];
+static GLIntercept::Frame frame;
+static uint64_t frameNanoseconds = 0;
+static uint64_t frames = 0;
+static FILE *trace = nullptr;
+
+template <typename T>
+static inline typename std::enable_if<std::is_integral<T>::value, uint64_t>::type Bits(T value)
+{
+    return uint64_t(int64_t(value));
+}
+
+static inline uint64_t Bits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline uint64_t Bits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+template <typename T>
+static inline uint64_t Bits(T *pointer)
+{
+    return uint64_t(reinterpret_cast<uintptr_t>(pointer));
+}
+
+// times the call it lives around and books it
+class CallScope {
+private:
+    int mFunction;
+    const uint64_t *mArgs;
+    uint16_t mArgCount;
+    std::chrono::steady_clock::time_point mStart;
+public:
+    CallScope(int function, const uint64_t *args, uint16_t argCount)
+            : mFunction(function), mArgs(args), mArgCount(argCount), mStart(std::chrono::steady_clock::now()) {}
+
+    ~CallScope() {
+        auto nanoseconds = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - this->mStart).count());
+        Counter &counter = counters[this->mFunction];
+        ++counter.calls;
+        counter.nanoseconds += nanoseconds;
+        ++frame.calls[int(categories[this->mFunction])];
+        frameNanoseconds += nanoseconds;
+        if (trace != nullptr) {
+            GLTraceRecord record = { uint16_t(this->mFunction), this->mArgCount, uint32_t(std::min<uint64_t>(nanoseconds, UINT32_MAX)) };
+            std::fwrite(&record, sizeof(record), 1, trace);
+            std::fwrite(this->mArgs, sizeof(uint64_t), this->mArgCount, trace);
+        }
+    }
+};
+
+// one wrapper per entry point, calling the driver's function through the saved pointer
+template <int Id, typename R, typename... A>
+struct Hook
+{
+    static R (APIENTRYP original)(A...);
+
+    static R APIENTRY Call(A... args) {
+        const uint64_t bits[sizeof...(A) + 1] = { Bits(args)..., 0 };
+        CallScope scope(Id, bits, uint16_t(sizeof...(A)));
+        return original(args...);
+    }
+};
+
+template <int Id, typename R, typename... A>
+R (APIENTRYP Hook<Id, R, A...>::original)(A...) = nullptr;
+
+template <int Id, typename R, typename... A>
+static void Install(R (APIENTRYP &slot)(A...))
+{
+    if (slot == nullptr)
+        return;
+    Hook<Id, R, A...>::original = slot;
+    slot = &Hook<Id, R, A...>::Call;
+}
+
+static bool StartsWith(const char *name, const char *prefix)
+{
+    return std::strncmp(name, prefix, std::strlen(prefix)) == 0;
+}
+
+static GLIntercept::Category Classify(const char *name)
+{
+    static const char *const draws[] = { "glDraw", "glMultiDraw", "glDispatch" };
+    static const char *const binds[] = { "glBind", "glUseProgram", "glActiveTexture" };
+    static const char *const state[] = { "glEnable", "glDisable", "glBlend", "glDepth", "glStencil", "glCullFace",
+                                         "glFrontFace", "glPolygonMode", "glLineWidth", "glPointSize", "glViewport",
+                                         "glScissor", "glClearColor", "glClearDepth", "glColorMask", "glPixelStore",
+                                         "glHint", "glVertexAttribPointer", "glVertexAttribDivisor", "glTexParameter" };
+    for (const char *prefix : draws)
+        if (StartsWith(name, prefix))
+            return GLIntercept::Category::DRAW;
+    for (const char *prefix : binds)
+        if (StartsWith(name, prefix))
+            return GLIntercept::Category::BIND;
+    if (StartsWith(name, "glUniform"))
+        return GLIntercept::Category::UNIFORM;
+    for (const char *prefix : state)
+        if (StartsWith(name, prefix))
+            return GLIntercept::Category::STATE;
+    return GLIntercept::Category::OTHER;
+}
+
+bool GLIntercept::Enable(const std::string &tracePath) {
+    if (enabled)
+        return true;
+    if (!tracePath.empty()) {
+        trace = std::fopen(tracePath.c_str(), "wb");
+        if (trace == nullptr) {
+            std::cout << "Failed to write GL trace " << tracePath << std::endl;
+            return false;
+        }
+        std::setvbuf(trace, nullptr, _IOFBF, GL_TRACE_BUFFER);
+        GLTraceHeader header{};
+        std::memcpy(header.magic, GL_TRACE_MAGIC, 4);
+        header.version = GL_TRACE_VERSION;
+        header.functionCount = GL_FUNCTION_COUNT;
+        std::fwrite(&header, sizeof(header), 1, trace);
+        for (const char *name : NAMES)
+        {
+            auto length = uint16_t(std::strlen(name));
+            std::fwrite(&length, sizeof(length), 1, trace);
+            std::fwrite(name, 1, length, trace);
+        }
+    }
+    for (int i = 0; i < GL_FUNCTION_COUNT; ++i)
+        categories[i] = Classify(NAMES[i]);
+#define GL_FUNCTION(name) Install<GL_ID_##name>(glad_##name);
+#include "GLFunctions.h"
+#undef GL_FUNCTION
+    enabled = true;
+    return true;
+}
+
+bool GLIntercept::IsEnabled() {
+    return enabled;
+}
+
+GLIntercept::Frame GLIntercept::EndFrame(bool print) {
+    Frame result = frame;
+    result.ms = double(frameNanoseconds) * 1e-6;
+    if (print) {
+        uint32_t calls = 0;
+        for (uint32_t count : result.calls)
+            calls += count;
+        std::printf("GL frame %llu: %u calls, %u draws, %u binds, %u uniforms, %u state, %u other, %.3f ms\n",
+                    (unsigned long long) frames, calls, result.calls[0], result.calls[1], result.calls[2],
+                    result.calls[3], result.calls[4], result.ms);
+    }
+    if (trace != nullptr) {
+        GLTraceRecord record = { GL_TRACE_FRAME, 0, 0 };
+        std::fwrite(&record, sizeof(record), 1, trace);
+    }
+    frame = {};
+    frameNanoseconds = 0;
+    ++frames;
+    return result;
+}
+
+void GLIntercept::PrintTotals(size_t rows) {
+    std::vector<int> order;
+    for (int i = 0; i < GL_FUNCTION_COUNT; ++i)
+        if (counters[i].calls > 0)
+            order.push_back(i);
+    std::sort(order.begin(), order.end(), [](int a, int b) { return counters[a].nanoseconds > counters[b].nanoseconds; });
+    std::printf("%-32s %12s %12s %12s %10s\n", "function", "calls", "per frame", "total ms", "mean us");
+    for (size_t k = 0; k < std::min(rows, order.size()); ++k)
+    {
+        const Counter &counter = counters[order[k]];
+        std::printf("%-32s %12llu %12.1f %12.3f %10.3f\n", NAMES[order[k]], (unsigned long long) counter.calls,
+                    double(counter.calls) / double(std::max<uint64_t>(frames, 1)), double(counter.nanoseconds) * 1e-6,
+                    double(counter.nanoseconds) * 1e-3 / double(counter.calls));
+    }
+}
+
+void GLIntercept::Close() {
+    if (trace != nullptr)
+        std::fclose(trace);
+    trace = nullptr;
+}
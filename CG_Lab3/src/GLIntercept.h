@@ -0,0 +1,59 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_GLINTERCEPT_H
+#define PROJECT_GLINTERCEPT_H
+
+#include <cstdint>
+#include <string>
+
+#define GL_TRACE_MAGIC "GLTR"
+#define GL_TRACE_VERSION 1
+// function id of the record closing a frame
+#define GL_TRACE_FRAME 0xFFFF
+
+// trace layout: header, the function names (uint16 length and the characters, in id order),
+// then per call a record followed by argCount arguments as uint64 (pointers as addresses, floats as bits)
+struct GLTraceHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t functionCount;
+};
+
+struct GLTraceRecord
+{
+    uint16_t function;
+    uint16_t argCount;
+    uint32_t nanoseconds;
+};
+
+
+// wraps the loaded glad entry points to count and time every call, optionally writing a binary trace.
+// nothing is wrapped until Enable, so a disabled layer costs nothing
+class GLIntercept {
+public:
+    enum class Category
+    {
+        DRAW, BIND, UNIFORM, STATE, OTHER
+    };
+    struct Frame
+    {
+        uint32_t calls[5];           // per category
+        double ms;                   // CPU time inside GL calls
+    };
+
+    // after the loader; tracePath empty for counters only
+    static bool Enable(const std::string &tracePath);
+    static bool IsEnabled();
+    // closes the frame in the counters and the trace, prints a line of it when asked
+    static Frame EndFrame(bool print);
+    // calls and time per function over the whole run, most expensive first
+    static void PrintTotals(size_t rows = 20);
+    // flushes the trace, the entry points stay wrapped
+    static void Close();
+};
+
+
+#endif //PROJECT_GLINTERCEPT_H
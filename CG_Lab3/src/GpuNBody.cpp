@@ -0,0 +1,80 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "GpuNBody.h"
+
+#include <vector>
+
+#define GPU_WORK_GROUP 128
+
+GpuNBody::GpuNBody(const std::string &path) : mProgram(path), mUniforms(mProgram) {
+    GLCall( glGenBuffers(2, this->mPositions) );
+    GLCall( glGenBuffers(1, &this->mVelocities) );
+}
+
+GpuNBody::~GpuNBody() {
+    GLCall( glDeleteBuffers(2, this->mPositions) );
+    GLCall( glDeleteBuffers(1, &this->mVelocities) );
+}
+
+bool GpuNBody::IsSupported() {
+    return GLAD_GL_VERSION_4_3 != 0;
+}
+
+void GpuNBody::Upload(const Bodies &bodies) {
+    this->mCount = bodies.Size();
+    this->mCurrent = 0;
+
+    std::vector<float> positions(this->mCount * 4), velocities(this->mCount * 4);
+    for (size_t i = 0; i < this->mCount; ++i)
+    {
+        positions[i*4 + 0] = bodies.x[i];
+        positions[i*4 + 1] = bodies.y[i];
+        positions[i*4 + 2] = bodies.z[i];
+        positions[i*4 + 3] = bodies.mass[i];
+        velocities[i*4 + 0] = bodies.vx[i];
+        velocities[i*4 + 1] = bodies.vy[i];
+        velocities[i*4 + 2] = bodies.vz[i];
+        velocities[i*4 + 3] = bodies.radius[i];
+    }
+
+    GLsizeiptr size = GLsizeiptr(positions.size() * sizeof(float));
+    for (unsigned int buffer : this->mPositions)
+    {
+        GLCall( glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer) );
+        GLCall( glBufferData(GL_SHADER_STORAGE_BUFFER, size, positions.data(), GL_DYNAMIC_COPY) );
+    }
+    GLCall( glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mVelocities) );
+    GLCall( glBufferData(GL_SHADER_STORAGE_BUFFER, size, velocities.data(), GL_DYNAMIC_COPY) );
+    GLCall( glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0) );
+}
+
+void GpuNBody::Step(float dt, int substeps) {
+    if (this->mCount == 0 || this->mProgram.getID() == 0)
+        return;
+
+    this->mProgram.Use();
+    this->mProgram.setInt(this->mUniforms.count, int(this->mCount));
+    this->mProgram.setFloat(this->mUniforms.dt, dt / float(substeps));
+    this->mProgram.setFloat(this->mUniforms.gravity, GRAVITY);
+    this->mProgram.setFloat(this->mUniforms.softening, SOFTENING);
+    GLCall( glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_VELOCITIES_BINDING, this->mVelocities) );
+
+    unsigned int groups = unsigned((this->mCount + GPU_WORK_GROUP - 1) / GPU_WORK_GROUP);
+    for (int s = 0; s < substeps; ++s)
+    {
+        GLCall( glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_POSITIONS_BINDING, this->mPositions[this->mCurrent]) );
+        GLCall( glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_POSITIONS_OUT_BINDING, this->mPositions[1 - this->mCurrent]) );
+        this->mProgram.Dispatch(groups);
+        // the next step and the draw read what this one wrote
+        GLCall( glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT) );
+        this->mCurrent = 1 - this->mCurrent;
+    }
+    this->mProgram.NotUse();
+}
+
+void GpuNBody::BindForDraw() const {
+    GLCall( glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_POSITIONS_BINDING, this->mPositions[this->mCurrent]) );
+    GLCall( glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_VELOCITIES_BINDING, this->mVelocities) );
+}
@@ -0,0 +1,46 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_GPUNBODY_H
+#define PROJECT_GPUNBODY_H
+
+#include <string>
+#include "Bodies.h"
+#include "Shader.h"
+#include "ShaderUniforms.h"
+
+// shader storage bindings shared by NBody.shader and Bodies.shader
+#define GPU_POSITIONS_BINDING 0
+#define GPU_POSITIONS_OUT_BINDING 1
+#define GPU_VELOCITIES_BINDING 2
+
+
+// direct-sum N-body integrated by a compute shader, the state stays in shader storage buffers
+class GpuNBody {
+private:
+    Shader mProgram;
+    Uniforms::NBody mUniforms;
+    unsigned int mPositions[2];     // xyz, mass; ping-pong between steps
+    unsigned int mVelocities;       // xyz, radius
+    int mCurrent = 0;
+    size_t mCount = 0;
+public:
+    // path to the compute shader file
+    explicit GpuNBody(const std::string &path);
+    ~GpuNBody();
+
+    // GL 4.3 compute and shader storage are available
+    static bool IsSupported();
+
+    inline size_t getCount() const { return this->mCount; }
+
+    // one-time copy of the CPU state, nothing is read back afterwards
+    void Upload(const Bodies &bodies);
+    void Step(float dt, int substeps = 1);
+    // binds the current positions and velocities for the vertex stage of Bodies.shader
+    void BindForDraw() const;
+};
+
+
+#endif //PROJECT_GPUNBODY_H
@@ -0,0 +1,23 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_HASH_H
+#define PROJECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define FNV1A_BASIS 0xCBF29CE484222325ull
+
+// 64 bit FNV-1a of size bytes, continuing from hash; start from FNV1A_BASIS
+static inline uint64_t Fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+
+#endif //PROJECT_HASH_H
@@ -0,0 +1,271 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include <glad/glad.h>
+#include "Headless.h"
+#include "ErrorChecker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+bool HeadlessOptions::Parse(int argc, char **argv, HeadlessOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") {
+            options.enabled = true;
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--dt" && hasValue) {
+            options.step = float(std::atof(argv[++i]));
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2
+                || options.width <= 0 || options.height <= 0) {
+                std::cout << "Size must look like 1920x1080" << std::endl;
+                return false;
+            }
+        } else if (arg == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            std::string format = argv[++i];
+            if (format != "ppm" && format != "png") {
+                std::cout << "Format must be ppm or png" << std::endl;
+                return false;
+            }
+            options.format = format == "png" ? ImageFormat::PNG : ImageFormat::PPM;
+        } else if (arg == "--every" && hasValue) {
+            options.every = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--path" && hasValue) {
+            options.cameraPath = argv[++i];
+        } else if (arg == "--scene" && hasValue) {
+            options.scene = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--report" && hasValue) {
+            options.report = argv[++i];
+        } else if (arg == "--record" && hasValue) {
+            options.record = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            options.replay = argv[++i];
+        } else if (arg == "--gl-stats") {
+            options.glStats = true;
+        } else if (arg == "--gl-trace" && hasValue) {
+            options.glTrace = argv[++i];
+            options.glStats = true;
+        } else if (arg == "--null-gl") {
+            options.nullGL = true;
+            options.enabled = true;
+        } else if (arg == "--gl-budget" && hasValue) {
+            options.glBudget = std::max(1, std::atoi(argv[++i]));
+            options.glStats = true;
+        } else if (arg == "--no-program-cache") {
+            options.programCache = false;
+        } else if (arg == "--watch-shaders") {
+            options.watchShaders = true;
+        } else {
+            std::cout << "Unknown argument " << arg << std::endl
+                      << "usage: " << argv[0] << " [--headless [--frames N] [--dt seconds] [--size WxH]"
+                      << " [--output directory] [--format ppm|png] [--every K]]"
+                      << " [--path file] [--scene N] [--report file.json] [--record file | --replay file]"
+                      << " [--gl-stats] [--gl-trace file] [--null-gl] [--gl-budget N] [--no-program-cache] [--watch-shaders]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+HeadlessContext::~HeadlessContext() {
+    this->Destroy();
+}
+
+bool HeadlessContext::Create(int width, int height) {
+#ifdef HEADLESS_EGL
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = getPlatformDisplay != nullptr
+            ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+            : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    // 4.5 for compute shaders and 3.3 if the driver has nothing newer
+    EGLContext context = EGL_NO_CONTEXT;
+    for (EGLint version : { 45, 33 })
+    {
+        EGLint attributes[] = { EGL_CONTEXT_MAJOR_VERSION, version / 10, EGL_CONTEXT_MINOR_VERSION, version % 10,
+                                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                EGL_CONTEXT_OPENGL_DEBUG, GL_ERROR_POLICY == GL_ERRORS_CALLBACK ? EGL_TRUE : EGL_FALSE, EGL_NONE };
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+        if (context != EGL_NO_CONTEXT)
+            break;
+    }
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cout << "Failed to create a surfaceless EGL context" << std::endl;
+        eglTerminate(display);
+        return false;
+    }
+    this->mDisplay = display;
+    this->mContext = context;
+    if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        this->Destroy();
+        return false;
+    }
+
+    this->mWidth = width;
+    this->mHeight = height;
+    GLCall(glGenFramebuffers(1, &this->mFramebuffer));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, this->mFramebuffer));
+    GLCall(glGenRenderbuffers(1, &this->mColor));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, this->mColor));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->mColor));
+    GLCall(glGenRenderbuffers(1, &this->mDepth));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, this->mDepth));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->mDepth));
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+        this->Destroy();
+        return false;
+    }
+    GLCall(glViewport(0, 0, width, height));
+    std::cout << "Headless: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+    return true;
+#else
+    std::cout << "Headless mode needs a build with EGL" << std::endl;
+    return false;
+#endif
+}
+
+void HeadlessContext::Destroy() {
+#ifdef HEADLESS_EGL
+    if (this->mContext == nullptr)
+        return;
+    if (this->mFramebuffer != 0) {
+        glDeleteRenderbuffers(1, &this->mColor);
+        glDeleteRenderbuffers(1, &this->mDepth);
+        glDeleteFramebuffers(1, &this->mFramebuffer);
+    }
+    eglMakeCurrent(this->mDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(this->mDisplay, this->mContext);
+    eglTerminate(this->mDisplay);
+#endif
+    this->mDisplay = nullptr;
+    this->mContext = nullptr;
+    this->mFramebuffer = this->mColor = this->mDepth = 0;
+}
+
+static uint32_t Crc32(const unsigned char *data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    if (table[1] == 0)
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBigEndian(std::vector<unsigned char> &out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back((unsigned char) (value >> shift));
+}
+
+static void PngChunk(FILE *file, const char *type, const std::vector<unsigned char> &data)
+{
+    std::vector<unsigned char> chunk;
+    PutBigEndian(chunk, uint32_t(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PutBigEndian(chunk, Crc32(chunk.data() + 4, chunk.size() - 4));
+    std::fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+// RGB, stored (uncompressed) deflate blocks: no zlib needed and fast enough for captures
+static bool WritePng(FILE *file, int width, int height, const unsigned char *rgb)
+{
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::fwrite(signature, 1, 8, file);
+
+    std::vector<unsigned char> header;
+    PutBigEndian(header, uint32_t(width));
+    PutBigEndian(header, uint32_t(height));
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });         // 8 bit RGB, no interlace
+    PngChunk(file, "IHDR", header);
+
+    // every row starts with filter type 0
+    size_t row = size_t(width) * 3;
+    std::vector<unsigned char> raw;
+    raw.reserve((row + 1) * height);
+    for (int y = 0; y < height; ++y)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y * row, rgb + (y + 1) * row);
+    }
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; )
+    {
+        size_t size = std::min<size_t>(raw.size() - offset, 65535);
+        bool last = offset + size == raw.size();
+        zlib.insert(zlib.end(), { (unsigned char) (last ? 1 : 0), (unsigned char) (size & 0xFF), (unsigned char) (size >> 8),
+                                  (unsigned char) (~size & 0xFF), (unsigned char) ((~size >> 8) & 0xFF) });
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+        for (size_t i = offset; i < offset + size; ++i)
+        {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        offset += size;
+        if (last)
+            break;
+    }
+    PutBigEndian(zlib, (b << 16) | a);
+    PngChunk(file, "IDAT", zlib);
+    PngChunk(file, "IEND", {});
+    return true;
+}
+
+bool HeadlessContext::WriteFrame(const std::string &path, ImageFormat format) {
+    size_t row = size_t(this->mWidth) * 3;
+    this->mPixels.resize(row * this->mHeight * 2);
+    unsigned char *pixels = this->mPixels.data(), *flipped = pixels + row * this->mHeight;
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GLCall(glReadPixels(0, 0, this->mWidth, this->mHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels));
+    // GL rows start at the bottom
+    for (int y = 0; y < this->mHeight; ++y)
+        std::memcpy(flipped + y * row, pixels + (this->mHeight - 1 - y) * row, row);
+
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cout << "Failed to write frame " << path << std::endl;
+        return false;
+    }
+    if (format == ImageFormat::PNG) {
+        WritePng(file, this->mWidth, this->mHeight, flipped);
+    } else {
+        std::fprintf(file, "P6\n%d %d\n255\n", this->mWidth, this->mHeight);
+        std::fwrite(flipped, 1, row * this->mHeight, file);
+    }
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,73 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_HEADLESS_H
+#define PROJECT_HEADLESS_H
+
+#include <string>
+#include <vector>
+
+enum class ImageFormat
+{
+    PPM, PNG
+};
+
+// command line of the offscreen mode and the camera-path benchmark:
+//   --headless [--frames N] [--dt seconds] [--size WxH] [--output directory] [--format ppm|png] [--every K]
+//   [--path file] [--scene N] [--report file.json] [--record file | --replay file] [--gl-stats] [--gl-trace file]
+//   [--null-gl] [--gl-budget calls]
+struct HeadlessOptions
+{
+    bool enabled = false;
+    int frames = 0;                    // 0 for the whole camera path or replay, or 600 frames without them
+    float step = 1.0f / 60.0f;        // fixed frame time instead of the clock
+    int width = 1920;
+    int height = 1080;
+    std::string output;                // frames are written here when set
+    ImageFormat format = ImageFormat::PPM;
+    int every = 1;                     // write every K-th frame
+    std::string cameraPath;            // flies the camera instead of the input
+    int scene = -1;                    // asteroid belt size, switches the GPU bodies on; -1 leaves the scene alone
+    std::string report;                // JSON frame time report
+    std::string record;                // input log to write
+    std::string replay;                // input log to play back instead of the input
+    bool glStats = false;              // GL calls counted and timed, a summary line per frame
+    std::string glTrace;               // binary trace of every GL call, implies glStats
+    bool nullGL = false;               // headless without any driver, GL calls do nothing
+    int glBudget = 0;                  // fails the run when a frame issues more GL calls, implies glStats
+    bool programCache = true;          // linked programs loaded from and stored to disk
+    bool watchShaders = false;         // reload saved shaders also without a window
+
+    // false and a message on unknown or malformed arguments
+    static bool Parse(int argc, char **argv, HeadlessOptions &options);
+};
+
+
+// OpenGL context without a window (EGL surfaceless, e.g. llvmpipe) rendering into a framebuffer object
+class HeadlessContext {
+private:
+    void *mDisplay = nullptr;
+    void *mContext = nullptr;
+    unsigned int mFramebuffer = 0;
+    unsigned int mColor = 0;
+    unsigned int mDepth = 0;
+    int mWidth = 0, mHeight = 0;
+    std::vector<unsigned char> mPixels;
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+    // 4.5 core and 3.3 core as fallback, loads glad and leaves the framebuffer bound
+    bool Create(int width, int height);
+    void Destroy();
+    inline bool IsCreated() const { return this->mContext != nullptr; }
+
+    // reads the framebuffer back and writes it top row first
+    bool WriteFrame(const std::string &path, ImageFormat format);
+};
+
+
+#endif //PROJECT_HEADLESS_H
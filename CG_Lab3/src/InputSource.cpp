@@ -0,0 +1,135 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "InputSource.h"
+
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <iostream>
+
+// keys polled every frame instead of handled as events
+static const int HELD_KEYS[] = {
+        GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_RIGHT, GLFW_KEY_LEFT,
+        GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D,
+        GLFW_KEY_LEFT_BRACKET, GLFW_KEY_RIGHT_BRACKET, GLFW_KEY_ESCAPE
+};
+static const int HELD_KEY_COUNT = sizeof(HELD_KEYS) / sizeof(HELD_KEYS[0]);
+
+static InputSource *Source(GLFWwindow *window)
+{
+    return static_cast<InputSource *>(glfwGetWindowUserPointer(window));
+}
+
+InputSource::InputSource(Mode mode, double step) : mMode(mode), mStep(step) {}
+
+InputSource::~InputSource() {
+    if (this->mRecord != nullptr)
+        std::fclose(this->mRecord);
+    if (this->mReplay != nullptr)
+        std::fclose(this->mReplay);
+}
+
+void InputSource::Attach(GLFWwindow *window) {
+    this->mWindow = window;
+    glfwSetWindowUserPointer(window, this);
+    glfwSetKeyCallback(window, KeyCallback);
+    glfwSetCursorPosCallback(window, CursorCallback);
+    glfwSetScrollCallback(window, ScrollCallback);
+    glfwSetMouseButtonCallback(window, MouseButtonCallback);
+    glfwSetFramebufferSizeCallback(window, ResizeCallback);
+}
+
+void InputSource::KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    Source(window)->mPending.push_back({ InputEventType::KEY, uint8_t(action), uint16_t(mods), key, 0.0, 0.0 });
+}
+
+void InputSource::CursorCallback(GLFWwindow *window, double x, double y) {
+    Source(window)->mPending.push_back({ InputEventType::CURSOR, 0, 0, 0, x, y });
+}
+
+void InputSource::ScrollCallback(GLFWwindow *window, double x, double y) {
+    Source(window)->mPending.push_back({ InputEventType::SCROLL, 0, 0, 0, x, y });
+}
+
+void InputSource::MouseButtonCallback(GLFWwindow *window, int button, int action, int mods) {
+    // cursor and framebuffer sizes differ on high-DPI screens, keep the position relative
+    int width, height;
+    double x, y;
+    glfwGetWindowSize(window, &width, &height);
+    glfwGetCursorPos(window, &x, &y);
+    Source(window)->mPending.push_back({ InputEventType::MOUSE_BUTTON, uint8_t(action), uint16_t(mods), button,
+                                         x / width, y / height });
+}
+
+void InputSource::ResizeCallback(GLFWwindow *window, int width, int height) {
+    Source(window)->mPending.push_back({ InputEventType::RESIZE, 0, 0, 0, double(width), double(height) });
+}
+
+bool InputSource::Record(const std::string &path) {
+    this->mRecord = std::fopen(path.c_str(), "wb");
+    InputLogHeader header{};
+    std::memcpy(header.magic, INPUT_MAGIC, 4);
+    header.version = INPUT_VERSION;
+    if (this->mRecord == nullptr || std::fwrite(&header, sizeof(header), 1, this->mRecord) != 1) {
+        std::cout << "Failed to write input log " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool InputSource::Replay(const std::string &path) {
+    this->mReplay = std::fopen(path.c_str(), "rb");
+    if (this->mReplay == nullptr) {
+        std::cout << "Failed to open input log " << path << std::endl;
+        return false;
+    }
+    InputLogHeader header{};
+    if (std::fread(&header, sizeof(header), 1, this->mReplay) != 1 || std::memcmp(header.magic, INPUT_MAGIC, 4) != 0
+        || header.version != INPUT_VERSION) {
+        std::cout << "Input log " << path << " has a wrong header" << std::endl;
+        return false;
+    }
+    this->mMode = Mode::REPLAY;
+    return true;
+}
+
+void InputSource::NextFrame() {
+    this->mEvents.clear();
+    if (this->mMode == Mode::REPLAY) {
+        this->mPending.clear();
+        this->mFinished = this->mFinished || std::fread(&this->mFrame, sizeof(InputFrame), 1, this->mReplay) != 1;
+        if (!this->mFinished) {
+            this->mEvents.resize(this->mFrame.events);
+            this->mFinished = this->mFrame.events > 0
+                    && std::fread(this->mEvents.data(), sizeof(InputEvent), this->mEvents.size(), this->mReplay) != this->mEvents.size();
+        }
+        if (this->mFinished) {
+            this->mEvents.clear();
+            this->mFrame.held = 0;
+        }
+    } else {
+        this->mEvents.swap(this->mPending);
+        this->mFrame.held = 0;
+        if (this->mMode == Mode::FIXED) {
+            this->mFrame.time += this->mStep;
+        } else {
+            this->mFrame.time = glfwGetTime();
+            for (int i = 0; i < HELD_KEY_COUNT; ++i)
+                this->mFrame.held |= glfwGetKey(this->mWindow, HELD_KEYS[i]) == GLFW_PRESS ? 1u << i : 0u;
+        }
+        this->mFrame.events = uint32_t(this->mEvents.size());
+    }
+
+    if (this->mRecord != nullptr && !this->mFinished) {
+        std::fwrite(&this->mFrame, sizeof(InputFrame), 1, this->mRecord);
+        std::fwrite(this->mEvents.data(), sizeof(InputEvent), this->mEvents.size(), this->mRecord);
+    }
+}
+
+bool InputSource::Held(int key) const {
+    for (int i = 0; i < HELD_KEY_COUNT; ++i)
+        if (HELD_KEYS[i] == key)
+            return (this->mFrame.held >> i & 1u) != 0;
+    return false;
+}
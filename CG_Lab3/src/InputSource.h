@@ -0,0 +1,97 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_INPUTSOURCE_H
+#define PROJECT_INPUTSOURCE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct GLFWwindow;
+
+#define INPUT_MAGIC "INPT"
+#define INPUT_VERSION 1
+
+enum class InputEventType : uint8_t
+{
+    KEY, CURSOR, SCROLL, MOUSE_BUTTON, RESIZE
+};
+
+// one GLFW callback: key or button code, action and mods, and the cursor position, scroll offset or size
+struct InputEvent
+{
+    InputEventType type;
+    uint8_t action;
+    uint16_t mods;
+    int32_t code;
+    double x, y;                     // the mouse button position is relative to the window size
+};
+
+// log layout: header, then per frame an InputFrame followed by its events
+struct InputLogHeader
+{
+    char magic[4];
+    uint32_t version;
+};
+
+struct InputFrame
+{
+    double time;
+    uint32_t held;                   // bit i: HELD_KEYS[i] is down
+    uint32_t events;
+};
+
+
+// the single source of frame time and input: live from GLFW (or a fixed step without a window),
+// optionally recorded to a binary log, or replayed from one bit for bit
+class InputSource {
+public:
+    enum class Mode
+    {
+        LIVE, FIXED, REPLAY
+    };
+private:
+    Mode mMode;
+    double mStep;
+    GLFWwindow *mWindow = nullptr;
+    FILE *mRecord = nullptr;
+    FILE *mReplay = nullptr;
+    bool mFinished = false;
+    InputFrame mFrame = {};
+    std::vector<InputEvent> mPending;      // arrived since the last frame
+    std::vector<InputEvent> mEvents;       // of the current frame
+
+    static void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+    static void CursorCallback(GLFWwindow *window, double x, double y);
+    static void ScrollCallback(GLFWwindow *window, double x, double y);
+    static void MouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
+    static void ResizeCallback(GLFWwindow *window, int width, int height);
+public:
+    // step is the frame time of FIXED
+    InputSource(Mode mode, double step = 0.0);
+    ~InputSource();
+    InputSource(const InputSource &) = delete;
+    InputSource &operator=(const InputSource &) = delete;
+
+    // takes over the window callbacks, events are queued until the next frame
+    void Attach(GLFWwindow *window);
+    // false and a message if the log cannot be written or read
+    bool Record(const std::string &path);
+    bool Replay(const std::string &path);
+
+    // time, held keys and events of the next frame; a finished replay leaves them empty
+    void NextFrame();
+    bool Held(int key) const;
+
+    inline double getTime() const { return this->mFrame.time; }
+    inline const std::vector<InputEvent> &getEvents() const { return this->mEvents; }
+    inline bool IsFinished() const { return this->mFinished; }
+    inline bool IsReplaying() const { return this->mMode == Mode::REPLAY; }
+    inline bool IsRecording() const { return this->mRecord != nullptr; }
+};
+
+
+#endif //PROJECT_INPUTSOURCE_H
@@ -0,0 +1,379 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Integrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// substep as a fraction of the shortest timescale |v| / |a|, about 600 steps per circular orbit
+#define ETA_ACCELERATION 0.01
+// Wisdom-Holman substep as a fraction of the orbital timescale of an encountering pair
+#define ETA_ENCOUNTER 0.05
+// Wisdom-Holman substep as a fraction of the shortest T / 2pi, about 60 steps per orbit
+#define ETA_KEPLER 0.1
+
+const char *IntegratorName(IntegratorType type)
+{
+    switch (type)
+    {
+        case IntegratorType::EULER :
+            return "semi-implicit Euler";
+        case IntegratorType::LEAPFROG :
+            return "leapfrog";
+        case IntegratorType::WISDOM_HOLMAN :
+            return "Wisdom-Holman";
+    }
+    return "unknown";
+}
+
+// Stumpff functions C(z) and S(z) of the universal variable formulation
+static void Stumpff(double z, double &c, double &s)
+{
+    if (z > 1e-6)
+    {
+        double q = std::sqrt(z);
+        c = (1.0 - std::cos(q)) / z;
+        s = (q - std::sin(q)) / (z * q);
+    }
+    else if (z < -1e-6)
+    {
+        double q = std::sqrt(-z);
+        c = (1.0 - std::cosh(q)) / z;
+        s = (std::sinh(q) - q) / (-z * q);
+    }
+    else
+    {
+        c = 1.0 / 2.0 - z / 24.0 + z * z / 720.0;
+        s = 1.0 / 6.0 - z / 120.0 + z * z / 5040.0;
+    }
+}
+
+// exact two-body drift for time h, works for bound and unbound orbits
+static void KeplerStep(double mu, double h, double r[3], double v[3])
+{
+    double r0 = std::sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+    double v2 = v[0]*v[0] + v[1]*v[1] + v[2]*v[2];
+    double sqrtMu = std::sqrt(mu);
+    double alpha = 2.0 / r0 - v2 / mu;
+    double sigma = (r[0]*v[0] + r[1]*v[1] + r[2]*v[2]) / sqrtMu;
+
+    // Newton on the universal anomaly, the substeps are short so chi starts close
+    double chi = sqrtMu * h / r0;
+    double c = 0.5, s = 1.0 / 6.0, radius = r0;
+    for (int k = 0; k < 50; ++k)
+    {
+        double chi2 = chi * chi;
+        Stumpff(alpha * chi2, c, s);
+        double f = sigma * chi2 * c + (1.0 - alpha * r0) * chi2 * chi * s + r0 * chi - sqrtMu * h;
+        radius = sigma * chi * (1.0 - alpha * chi2 * s) + (1.0 - alpha * r0) * chi2 * c + r0;
+        double delta = f / radius;
+        chi -= delta;
+        if (std::fabs(delta) <= 1e-14 * std::max(1.0, std::fabs(chi)))
+            break;
+    }
+
+    double chi2 = chi * chi;
+    Stumpff(alpha * chi2, c, s);
+    double f = 1.0 - chi2 / r0 * c;
+    double g = h - chi2 * chi * s / sqrtMu;
+    double rn[3] = { f*r[0] + g*v[0], f*r[1] + g*v[1], f*r[2] + g*v[2] };
+    radius = std::sqrt(rn[0]*rn[0] + rn[1]*rn[1] + rn[2]*rn[2]);
+    double fDot = sqrtMu / (radius * r0) * (alpha * chi2 * s - 1.0) * chi;
+    double gDot = 1.0 - chi2 / radius * c;
+    for (int k = 0; k < 3; ++k)
+    {
+        double vn = fDot * r[k] + gDot * v[k];
+        r[k] = rn[k];
+        v[k] = vn;
+    }
+}
+
+Integrator::Integrator(NBody &nbody, IntegratorType type) : mNBody(nbody), mType(type) {
+
+}
+
+Integrator::~Integrator() {
+
+}
+
+double Integrator::Timescale(IntegratorType type) const {
+    double tau = std::numeric_limits<double>::infinity();
+    const Bodies &b = type == IntegratorType::WISDOM_HOLMAN ? this->mHelio : this->mNBody.getBodies();
+
+    // velocities relative to the barycentre, Wisdom-Holman keeps them that way already
+    double vc[3] = { 0.0, 0.0, 0.0 };
+    if (type != IntegratorType::WISDOM_HOLMAN)
+    {
+        double mass = 0.0;
+        for (size_t i = 0; i < b.Size(); ++i)
+        {
+            mass += b.mass[i];
+            vc[0] += double(b.mass[i]) * b.vx[i];
+            vc[1] += double(b.mass[i]) * b.vy[i];
+            vc[2] += double(b.mass[i]) * b.vz[i];
+        }
+        for (int k = 0; mass > 0.0 && k < 3; ++k)
+            vc[k] /= mass;
+    }
+
+    // close encounters show up as large accelerations relative to the velocity; a body at rest
+    // is limited by the time it needs to fall through its own radius instead
+    for (size_t i = 0; i < b.Size(); ++i)
+    {
+        double a2 = double(b.ax[i])*b.ax[i] + double(b.ay[i])*b.ay[i] + double(b.az[i])*b.az[i];
+        if (a2 <= 0.0 || b.mass[i] <= 0.0)
+            continue;
+        double dvx = b.vx[i] - vc[0], dvy = b.vy[i] - vc[1], dvz = b.vz[i] - vc[2];
+        double a = std::sqrt(a2);
+        double t = std::max(std::sqrt(dvx*dvx + dvy*dvy + dvz*dvz) / a, std::sqrt(b.radius[i] / a));
+        tau = std::min(tau, ETA_ACCELERATION * t);
+
+        // Wisdom-Holman sees only the interactions: the encounter distance d = sqrt(G m / a) assumes
+        // a partner of similar mass, their mutual orbital timescale is sqrt(d^3 / 2 G m)
+        if (type == IntegratorType::WISDOM_HOLMAN)
+        {
+            double gm = GRAVITY * double(b.mass[i]);
+            double d = std::sqrt(gm / a);
+            tau = std::min(tau, ETA_ENCOUNTER * std::sqrt(d * d * d / (2.0 * gm)));
+        }
+    }
+
+    // the Kepler part is exact, but the splitting error grows with the orbital frequency
+    if (type == IntegratorType::WISDOM_HOLMAN)
+    {
+        double mu = GRAVITY * this->mNBody.getBodies().mass[0];
+        for (size_t i = 1; i < b.Size(); ++i)
+        {
+            double r2 = double(b.x[i])*b.x[i] + double(b.y[i])*b.y[i] + double(b.z[i])*b.z[i];
+            tau = std::min(tau, ETA_KEPLER * std::sqrt(r2 * std::sqrt(r2) / mu));
+        }
+    }
+    return tau;
+}
+
+double Integrator::Advance(float dt) {
+    Bodies &bodies = this->mNBody.getBodies();
+    double total = double(dt) * this->mWarp;
+    this->mLastSubsteps = 0;
+    if (total <= 0.0 || bodies.Size() == 0)
+        return 0.0;
+
+    // Wisdom-Holman needs a massive body 0 to orbit, otherwise leapfrog takes over
+    bool helio = this->mType == IntegratorType::WISDOM_HOLMAN && bodies.Size() > 1 && bodies.mass[0] > 0.0f;
+    IntegratorType type = helio ? IntegratorType::WISDOM_HOLMAN :
+                          (this->mType == IntegratorType::WISDOM_HOLMAN ? IntegratorType::LEAPFROG : this->mType);
+    if (helio)
+    {
+        this->ToHeliocentric();
+        this->mNBody.ComputeAccelerations(this->mHelio);
+    }
+    else
+    {
+        this->mNBody.ComputeAccelerations();
+    }
+
+    // the substep is re-chosen after every force pass as total / 2^k, so encounters that start in
+    // the middle of a long time-warp frame are resolved as well
+    double remaining = total;
+    int substeps = 0;
+    while (remaining > 0.0 && substeps < this->mMaxSubsteps)
+    {
+        double tau = this->Timescale(type);
+        double h = total;
+        while (h > tau && h * this->mMaxSubsteps > total)
+            h *= 0.5;
+        h = std::min(h, remaining);
+
+        switch (type)
+        {
+            case IntegratorType::EULER :
+                this->EulerStep(h);
+                break;
+            case IntegratorType::LEAPFROG :
+                this->LeapfrogStep(h);
+                break;
+            case IntegratorType::WISDOM_HOLMAN :
+                this->WisdomHolmanStep(h);
+                break;
+        }
+        remaining -= h;
+        ++substeps;
+    }
+    // out of substeps: the warp saturates instead of the accuracy
+    total -= remaining;
+
+    if (helio)
+        this->FromHeliocentric(total);
+    this->mLastSubsteps = substeps;
+    return total;
+}
+
+void Integrator::EulerStep(double h) {
+    Bodies &b = this->mNBody.getBodies();
+    float dt = float(h);
+    for (size_t i = 0; i < b.Size(); ++i)
+    {
+        b.vx[i] += b.ax[i] * dt;
+        b.vy[i] += b.ay[i] * dt;
+        b.vz[i] += b.az[i] * dt;
+        b.x[i] += b.vx[i] * dt;
+        b.y[i] += b.vy[i] * dt;
+        b.z[i] += b.vz[i] * dt;
+    }
+    this->mNBody.ComputeAccelerations();
+}
+
+// kick-drift-kick, the accelerations of the last kick are reused by the next first kick
+void Integrator::LeapfrogStep(double h) {
+    Bodies &b = this->mNBody.getBodies();
+    float half = float(0.5 * h), dt = float(h);
+    for (size_t i = 0; i < b.Size(); ++i)
+    {
+        b.vx[i] += b.ax[i] * half;
+        b.vy[i] += b.ay[i] * half;
+        b.vz[i] += b.az[i] * half;
+        b.x[i] += b.vx[i] * dt;
+        b.y[i] += b.vy[i] * dt;
+        b.z[i] += b.vz[i] * dt;
+    }
+    this->mNBody.ComputeAccelerations();
+    for (size_t i = 0; i < b.Size(); ++i)
+    {
+        b.vx[i] += b.ax[i] * half;
+        b.vy[i] += b.ay[i] * half;
+        b.vz[i] += b.az[i] * half;
+    }
+}
+
+// positions relative to body 0, velocities relative to the barycentre; body 0 gets no mass so
+// the force kernels see only the interactions between the other bodies
+void Integrator::ToHeliocentric() {
+    const Bodies &b = this->mNBody.getBodies();
+    double mass = 0.0, momentum[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < b.Size(); ++i)
+    {
+        mass += b.mass[i];
+        momentum[0] += double(b.mass[i]) * b.vx[i];
+        momentum[1] += double(b.mass[i]) * b.vy[i];
+        momentum[2] += double(b.mass[i]) * b.vz[i];
+    }
+
+    this->mHelio = b;
+    Bodies &h = this->mHelio;
+    for (int k = 0; k < 3; ++k)
+        this->mBarycentreVelocity[k] = momentum[k] / mass;
+    for (size_t i = 0; i < h.Size(); ++i)
+    {
+        h.x[i] = b.x[i] - b.x[0];
+        h.y[i] = b.y[i] - b.y[0];
+        h.z[i] = b.z[i] - b.z[0];
+        h.vx[i] = float(b.vx[i] - this->mBarycentreVelocity[0]);
+        h.vy[i] = float(b.vy[i] - this->mBarycentreVelocity[1]);
+        h.vz[i] = float(b.vz[i] - this->mBarycentreVelocity[2]);
+    }
+    h.mass[0] = 0.0f;
+    h.vx[0] = h.vy[0] = h.vz[0] = 0.0f;
+
+    this->mBarycentre[0] = this->mBarycentre[1] = this->mBarycentre[2] = 0.0;
+    for (size_t i = 0; i < b.Size(); ++i)
+    {
+        this->mBarycentre[0] += double(b.mass[i]) * b.x[i] / mass;
+        this->mBarycentre[1] += double(b.mass[i]) * b.y[i] / mass;
+        this->mBarycentre[2] += double(b.mass[i]) * b.z[i] / mass;
+    }
+}
+
+void Integrator::FromHeliocentric(double elapsed) {
+    Bodies &b = this->mNBody.getBodies();
+    const Bodies &h = this->mHelio;
+    double central = b.mass[0], mass = 0.0;
+    double offset[3] = { 0.0, 0.0, 0.0 }, momentum[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i < b.Size(); ++i)
+        mass += b.mass[i];
+    for (size_t i = 1; i < h.Size(); ++i)
+    {
+        offset[0] += double(h.mass[i]) * h.x[i];
+        offset[1] += double(h.mass[i]) * h.y[i];
+        offset[2] += double(h.mass[i]) * h.z[i];
+        momentum[0] += double(h.mass[i]) * h.vx[i];
+        momentum[1] += double(h.mass[i]) * h.vy[i];
+        momentum[2] += double(h.mass[i]) * h.vz[i];
+    }
+
+    // the barycentre moves uniformly, body 0 balances the momentum of the others
+    double origin[3], v0[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        this->mBarycentre[k] += this->mBarycentreVelocity[k] * elapsed;
+        origin[k] = this->mBarycentre[k] - offset[k] / mass;
+        v0[k] = this->mBarycentreVelocity[k] - momentum[k] / central;
+    }
+
+    b.x[0] = float(origin[0]); b.y[0] = float(origin[1]); b.z[0] = float(origin[2]);
+    b.vx[0] = float(v0[0]); b.vy[0] = float(v0[1]); b.vz[0] = float(v0[2]);
+    for (size_t i = 1; i < b.Size(); ++i)
+    {
+        b.x[i] = float(h.x[i] + origin[0]);
+        b.y[i] = float(h.y[i] + origin[1]);
+        b.z[i] = float(h.z[i] + origin[2]);
+        b.vx[i] = float(h.vx[i] + this->mBarycentreVelocity[0]);
+        b.vy[i] = float(h.vy[i] + this->mBarycentreVelocity[1]);
+        b.vz[i] = float(h.vz[i] + this->mBarycentreVelocity[2]);
+    }
+}
+
+void Integrator::InteractionKick(double h) {
+    Bodies &b = this->mHelio;
+    float dt = float(h);
+    for (size_t i = 1; i < b.Size(); ++i)
+    {
+        b.vx[i] += b.ax[i] * dt;
+        b.vy[i] += b.ay[i] * dt;
+        b.vz[i] += b.az[i] * dt;
+    }
+}
+
+// drift of the heliocentric positions with the barycentric momentum of the planets
+void Integrator::Jump(double h) {
+    Bodies &b = this->mHelio;
+    double momentum[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 1; i < b.Size(); ++i)
+    {
+        momentum[0] += double(b.mass[i]) * b.vx[i];
+        momentum[1] += double(b.mass[i]) * b.vy[i];
+        momentum[2] += double(b.mass[i]) * b.vz[i];
+    }
+    double scale = h / this->mNBody.getBodies().mass[0];
+    for (size_t i = 1; i < b.Size(); ++i)
+    {
+        b.x[i] += float(momentum[0] * scale);
+        b.y[i] += float(momentum[1] * scale);
+        b.z[i] += float(momentum[2] * scale);
+    }
+}
+
+void Integrator::KeplerDrift(double h) {
+    Bodies &b = this->mHelio;
+    double mu = GRAVITY * double(this->mNBody.getBodies().mass[0]);
+    for (size_t i = 1; i < b.Size(); ++i)
+    {
+        double r[3] = { b.x[i], b.y[i], b.z[i] };
+        double v[3] = { b.vx[i], b.vy[i], b.vz[i] };
+        KeplerStep(mu, h, r, v);
+        b.x[i] = float(r[0]); b.y[i] = float(r[1]); b.z[i] = float(r[2]);
+        b.vx[i] = float(v[0]); b.vy[i] = float(v[1]); b.vz[i] = float(v[2]);
+    }
+}
+
+// democratic heliocentric splitting: kick, jump, Kepler drift, jump, kick
+void Integrator::WisdomHolmanStep(double h) {
+    this->InteractionKick(0.5 * h);
+    this->Jump(0.5 * h);
+    this->KeplerDrift(h);
+    this->Jump(0.5 * h);
+    this->mNBody.ComputeAccelerations(this->mHelio);
+    this->InteractionKick(0.5 * h);
+}
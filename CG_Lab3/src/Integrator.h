@@ -0,0 +1,58 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_INTEGRATOR_H
+#define PROJECT_INTEGRATOR_H
+
+#include "NBody.h"
+
+enum class IntegratorType
+{
+    EULER, LEAPFROG, WISDOM_HOLMAN
+};
+
+const char *IntegratorName(IntegratorType type);
+
+
+// advances an NBody by a frame, split into substeps sized from the current dynamics
+class Integrator {
+private:
+    NBody &mNBody;
+    IntegratorType mType;
+    float mWarp = 1.0f;
+    int mMaxSubsteps = 100000;
+    int mLastSubsteps = 0;
+    // democratic heliocentric state of the Wisdom-Holman map, central body at index 0
+    Bodies mHelio;
+    double mBarycentre[3];
+    double mBarycentreVelocity[3];
+
+    double Timescale(IntegratorType type) const;
+    void EulerStep(double h);
+    void LeapfrogStep(double h);
+    void ToHeliocentric();
+    void FromHeliocentric(double elapsed);
+    void InteractionKick(double h);
+    void Jump(double h);
+    void KeplerDrift(double h);
+    void WisdomHolmanStep(double h);
+public:
+    explicit Integrator(NBody &nbody, IntegratorType type = IntegratorType::LEAPFROG);
+    ~Integrator();
+
+    inline void setType(IntegratorType type) { this->mType = type; }
+    inline IntegratorType getType() const { return this->mType; }
+    // simulated seconds per real second
+    inline void setWarp(float warp) { this->mWarp = warp; }
+    inline float getWarp() const { return this->mWarp; }
+    inline void setMaxSubsteps(int substeps) { this->mMaxSubsteps = substeps; }
+    inline int getLastSubsteps() const { return this->mLastSubsteps; }
+
+    // advances by dt real seconds, i.e. dt * warp simulated seconds unless the substep limit is hit;
+    // returns the simulated time
+    double Advance(float dt);
+};
+
+
+#endif //PROJECT_INTEGRATOR_H
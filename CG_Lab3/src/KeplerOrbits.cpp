@@ -0,0 +1,271 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "KeplerOrbits.h"
+#include "Hash.h"
+#include "Simd.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+#define TWO_PI 6.283185307179586
+// fixed Newton count of the vector path, enough for e < 0.95 from the starting guess below
+#define KEPLER_ITERATIONS 5
+
+// starting guess: third order series for moderate e, Danby's M + 0.85 e for very eccentric orbits
+static inline double StartingGuess(double M, double e)
+{
+    if (e < 0.8)
+        return M + e * std::sin(M) * (1.0 + e * std::cos(M));
+    return M + (std::sin(M) < 0.0 ? -0.85 : 0.85) * e;
+}
+
+// Cephes style sincos, |x| up to a few pi
+__attribute__((target("avx2,fma")))
+static inline void SinCos(__m256 x, __m256 &s, __m256 &c)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_andnot_ps(signMask, x);
+
+    // octant, rounded up to an even number
+    __m256i j = _mm256_cvttps_epi32(_mm256_mul_ps(ax, _mm256_set1_ps(1.27323954473516f)));
+    j = _mm256_and_si256(_mm256_add_epi32(j, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+    __m256 y = _mm256_cvtepi32_ps(j);
+
+    // extended precision reduction to [-pi/4, pi/4]
+    ax = _mm256_fnmadd_ps(y, _mm256_set1_ps(0.78515625f), ax);
+    ax = _mm256_fnmadd_ps(y, _mm256_set1_ps(2.4187564849853515625e-4f), ax);
+    ax = _mm256_fnmadd_ps(y, _mm256_set1_ps(3.77489497744594108e-8f), ax);
+    __m256 z = _mm256_mul_ps(ax, ax);
+
+    __m256 ps = _mm256_fmadd_ps(_mm256_set1_ps(-1.9515295891e-4f), z, _mm256_set1_ps(8.3321608736e-3f));
+    ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(-1.6666654611e-1f));
+    ps = _mm256_fmadd_ps(_mm256_mul_ps(ps, z), ax, ax);
+
+    __m256 pc = _mm256_fmadd_ps(_mm256_set1_ps(2.443315711809948e-5f), z, _mm256_set1_ps(-1.388731625493765e-3f));
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(4.166664568298827e-2f));
+    pc = _mm256_fmadd_ps(_mm256_mul_ps(pc, z), z, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.0f)));
+
+    // octants 2 and 6 swap the polynomials, octant bit 4 flips sin, bit 2 xor bit 4 flips cos
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, _mm256_set1_epi32(2)), _mm256_set1_epi32(2)));
+    __m256 sinSign = _mm256_xor_ps(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(j, _mm256_set1_epi32(4)), 29)),
+                                   _mm256_and_ps(x, signMask));
+    __m256i cosBits = _mm256_xor_si256(_mm256_slli_epi32(j, 29), _mm256_slli_epi32(j, 30));
+    __m256 cosSign = _mm256_and_ps(_mm256_castsi256_ps(cosBits), signMask);
+
+    s = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sinSign);
+    c = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cosSign);
+}
+
+// sin and cos of the eccentric anomaly for mean anomalies M in [-pi, pi], same starting guess as the scalar path
+__attribute__((target("avx2,fma")))
+static inline void SolveKepler(__m256 M, __m256 e, __m256 &s, __m256 &c)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    // both candidates of the starting guess are computed and blended
+    __m256 sM, cM;
+    SinCos(M, sM, cM);
+    __m256 series = _mm256_fmadd_ps(_mm256_mul_ps(e, sM), _mm256_fmadd_ps(e, cM, one), M);
+    __m256 danby = _mm256_fmadd_ps(_mm256_or_ps(_mm256_set1_ps(0.85f), _mm256_and_ps(sM, signMask)), e, M);
+    __m256 E = _mm256_blendv_ps(series, danby, _mm256_cmp_ps(e, _mm256_set1_ps(0.8f), _CMP_GE_OQ));
+
+    for (int k = 0; k < KEPLER_ITERATIONS; ++k)
+    {
+        SinCos(E, s, c);
+        __m256 f = _mm256_sub_ps(_mm256_fnmadd_ps(e, s, E), M);
+        __m256 df = _mm256_fnmadd_ps(e, c, one);
+        E = _mm256_sub_ps(E, _mm256_div_ps(f, df));
+    }
+    SinCos(E, s, c);
+}
+
+KeplerOrbits::KeplerOrbits(float centralMass) : mMu(GRAVITY * centralMass) {
+
+}
+
+KeplerOrbits::~KeplerOrbits() {
+
+}
+
+size_t KeplerOrbits::Add(const OrbitalElements &elements) {
+    double a = elements.semiMajorAxis, e = elements.eccentricity;
+    double b = a * std::sqrt(1.0 - e * e);
+    double cO = std::cos(elements.ascendingNode), sO = std::sin(elements.ascendingNode);
+    double cw = std::cos(elements.periapsis), sw = std::sin(elements.periapsis);
+    double ci = std::cos(elements.inclination), si = std::sin(elements.inclination);
+
+    // perifocal axes in a z-up frame ...
+    double P[3] = { cO*cw - sO*sw*ci, sO*cw + cO*sw*ci, sw*si };
+    double Q[3] = { -cO*sw - sO*cw*ci, -sO*sw + cO*cw*ci, cw*si };
+    // ... mapped to the y-up scene as (X, Y, Z) -> (z, x, y)
+    this->mAX.push_back(float(a * P[1])); this->mAY.push_back(float(a * P[2])); this->mAZ.push_back(float(a * P[0]));
+    this->mBX.push_back(float(b * Q[1])); this->mBY.push_back(float(b * Q[2])); this->mBZ.push_back(float(b * Q[0]));
+    this->mCX.push_back(float(-a * e * P[1])); this->mCY.push_back(float(-a * e * P[2])); this->mCZ.push_back(float(-a * e * P[0]));
+    this->mE.push_back(float(e));
+    this->mM0.push_back(elements.meanAnomaly);
+    this->mN.push_back(std::sqrt(this->mMu / (a * a * a)));
+    return this->mCount++;
+}
+
+uint64_t KeplerOrbits::Key() const {
+    // the stored terms are derived from the elements and the central mass alone
+    uint64_t hash = Fnv1a(FNV1A_BASIS, &this->mMu, sizeof(this->mMu));
+    for (const std::vector<float> *terms : { &this->mAX, &this->mAY, &this->mAZ, &this->mBX, &this->mBY, &this->mBZ,
+                                             &this->mCX, &this->mCY, &this->mCZ, &this->mE })
+        hash = Fnv1a(hash, terms->data(), terms->size() * sizeof(float));
+    for (const std::vector<double> *terms : { &this->mM0, &this->mN })
+        hash = Fnv1a(hash, terms->data(), terms->size() * sizeof(double));
+    return hash;
+}
+
+void KeplerOrbits::State(size_t i, double t, glm::vec3 &position, glm::vec3 &velocity) const {
+    double e = this->mE[i];
+    double M = std::remainder(this->mM0[i] + this->mN[i] * t, TWO_PI);
+    double E = StartingGuess(M, e);
+    for (int k = 0; k < 32; ++k)
+    {
+        double dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+        E -= dE;
+        if (std::fabs(dE) < 1e-12)
+            break;
+    }
+
+    float c = float(std::cos(E)), s = float(std::sin(E));
+    glm::vec3 A(this->mAX[i], this->mAY[i], this->mAZ[i]);
+    glm::vec3 B(this->mBX[i], this->mBY[i], this->mBZ[i]);
+    glm::vec3 C(this->mCX[i], this->mCY[i], this->mCZ[i]);
+    position = A * c + B * s + C;
+    velocity = (B * c - A * s) * float(this->mN[i] / (1.0 - e * c));
+}
+
+// reference path, converges every orbit to full double precision
+void KeplerOrbits::ScalarRange(double t, size_t begin, size_t end, float *x, float *y, float *z) const {
+    for (size_t i = begin; i < end; ++i)
+    {
+        glm::vec3 position, velocity;
+        this->State(i, t, position, velocity);
+        x[i] = position.x;
+        y[i] = position.y;
+        z[i] = position.z;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void KeplerOrbits::AVX2Range(double t, size_t begin, size_t end, float *x, float *y, float *z) const {
+    const __m256d time = _mm256_set1_pd(t);
+    const __m256d twoPi = _mm256_set1_pd(TWO_PI);
+    const __m256d invTwoPi = _mm256_set1_pd(1.0 / TWO_PI);
+
+    for (size_t i = begin; i + 8 <= end; i += 8)
+    {
+        // mean anomaly wrapped to [-pi, pi] in double, then narrowed
+        __m128 half[2];
+        for (int h = 0; h < 2; ++h)
+        {
+            __m256d M = _mm256_fmadd_pd(_mm256_loadu_pd(&this->mN[i + 4*h]), time, _mm256_loadu_pd(&this->mM0[i + 4*h]));
+            __m256d turns = _mm256_round_pd(_mm256_mul_pd(M, invTwoPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            half[h] = _mm256_cvtpd_ps(_mm256_fnmadd_pd(turns, twoPi, M));
+        }
+        __m256 s, c;
+        SolveKepler(_mm256_set_m128(half[1], half[0]), _mm256_loadu_ps(&this->mE[i]), s, c);
+
+        _mm256_storeu_ps(x + i, _mm256_fmadd_ps(_mm256_loadu_ps(&this->mAX[i]), c,
+                                 _mm256_fmadd_ps(_mm256_loadu_ps(&this->mBX[i]), s, _mm256_loadu_ps(&this->mCX[i]))));
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(_mm256_loadu_ps(&this->mAY[i]), c,
+                                 _mm256_fmadd_ps(_mm256_loadu_ps(&this->mBY[i]), s, _mm256_loadu_ps(&this->mCY[i]))));
+        _mm256_storeu_ps(z + i, _mm256_fmadd_ps(_mm256_loadu_ps(&this->mAZ[i]), c,
+                                 _mm256_fmadd_ps(_mm256_loadu_ps(&this->mBZ[i]), s, _mm256_loadu_ps(&this->mCZ[i]))));
+    }
+}
+
+void KeplerOrbits::ScalarGather(const uint32_t *indices, const double *t, size_t begin, size_t end,
+                                float *x, float *y, float *z, float *vx, float *vy, float *vz) const {
+    for (size_t k = begin; k < end; ++k)
+    {
+        glm::vec3 position, velocity;
+        this->State(indices[k], t[k], position, velocity);
+        x[k] = position.x;
+        y[k] = position.y;
+        z[k] = position.z;
+        vx[k] = velocity.x;
+        vy[k] = velocity.y;
+        vz[k] = velocity.z;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void KeplerOrbits::AVX2Gather(const uint32_t *indices, const double *t, size_t begin, size_t end,
+                              float *x, float *y, float *z, float *vx, float *vy, float *vz) const {
+    const __m256d twoPi = _mm256_set1_pd(TWO_PI);
+    const __m256d invTwoPi = _mm256_set1_pd(1.0 / TWO_PI);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    for (size_t k = begin; k + 8 <= end; k += 8)
+    {
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices + k));
+        // as in AVX2Range, with every orbit at its own time
+        __m128 half[2], motion[2];
+        for (int h = 0; h < 2; ++h)
+        {
+            __m128i quarter = h == 0 ? _mm256_castsi256_si128(index) : _mm256_extracti128_si256(index, 1);
+            __m256d n = _mm256_i32gather_pd(this->mN.data(), quarter, 8);
+            __m256d M = _mm256_fmadd_pd(n, _mm256_loadu_pd(t + k + 4*h), _mm256_i32gather_pd(this->mM0.data(), quarter, 8));
+            __m256d turns = _mm256_round_pd(_mm256_mul_pd(M, invTwoPi), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            half[h] = _mm256_cvtpd_ps(_mm256_fnmadd_pd(turns, twoPi, M));
+            motion[h] = _mm256_cvtpd_ps(n);
+        }
+        __m256 e = _mm256_i32gather_ps(this->mE.data(), index, 4);
+        __m256 s, c;
+        SolveKepler(_mm256_set_m128(half[1], half[0]), e, s, c);
+        // dE/dt = n / (1 - e cos E)
+        __m256 rate = _mm256_div_ps(_mm256_set_m128(motion[1], motion[0]), _mm256_fnmadd_ps(e, c, one));
+
+        const float *A[3] = { this->mAX.data(), this->mAY.data(), this->mAZ.data() };
+        const float *B[3] = { this->mBX.data(), this->mBY.data(), this->mBZ.data() };
+        const float *C[3] = { this->mCX.data(), this->mCY.data(), this->mCZ.data() };
+        float *position[3] = { x, y, z }, *velocity[3] = { vx, vy, vz };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            __m256 a = _mm256_i32gather_ps(A[axis], index, 4);
+            __m256 b = _mm256_i32gather_ps(B[axis], index, 4);
+            _mm256_storeu_ps(position[axis] + k,
+                             _mm256_fmadd_ps(a, c, _mm256_fmadd_ps(b, s, _mm256_i32gather_ps(C[axis], index, 4))));
+            _mm256_storeu_ps(velocity[axis] + k, _mm256_mul_ps(_mm256_fmsub_ps(b, c, _mm256_mul_ps(a, s)), rate));
+        }
+    }
+}
+
+void KeplerOrbits::Propagate(const uint32_t *indices, const double *t, size_t count,
+                             float *x, float *y, float *z, float *vx, float *vy, float *vz, Path path) const {
+    size_t vectorEnd = 0;
+    if (path == Path::AVX2 && CpuHasAVX2())
+    {
+        vectorEnd = count & ~size_t(7);
+        this->AVX2Gather(indices, t, 0, vectorEnd, x, y, z, vx, vy, vz);
+    }
+    this->ScalarGather(indices, t, vectorEnd, count, x, y, z, vx, vy, vz);
+}
+
+void KeplerOrbits::Propagate(double t, float *x, float *y, float *z, Path path) const {
+    size_t vectorEnd = 0;
+    if (path == Path::AVX2 && CpuHasAVX2())
+    {
+        vectorEnd = this->mCount & ~size_t(7);
+        this->AVX2Range(t, 0, vectorEnd, x, y, z);
+    }
+    this->ScalarRange(t, vectorEnd, this->mCount, x, y, z);
+}
+
+void KeplerOrbits::Propagate(double t, Bodies &bodies, size_t first, const glm::vec3 &focus, Path path) const {
+    float *x = &bodies.x[first], *y = &bodies.y[first], *z = &bodies.z[first];
+    this->Propagate(t, x, y, z, path);
+    for (size_t i = 0; i < this->mCount; ++i)
+    {
+        x[i] += focus.x;
+        y[i] += focus.y;
+        z[i] += focus.z;
+    }
+}
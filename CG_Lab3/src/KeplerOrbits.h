@@ -0,0 +1,70 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_KEPLERORBITS_H
+#define PROJECT_KEPLERORBITS_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bodies.h"
+
+// classical elements, angles in radians, the reference plane is the scene xz plane
+struct OrbitalElements
+{
+    float semiMajorAxis;
+    float eccentricity;       // 0 <= e < 1
+    float inclination;
+    float ascendingNode;      // longitude of the ascending node
+    float periapsis;          // argument of periapsis
+    float meanAnomaly;        // at time 0
+};
+
+
+// elliptic two-body orbits around one central mass, propagated analytically in batches
+class KeplerOrbits {
+public:
+    enum class Path
+    {
+        SCALAR, AVX2
+    };
+private:
+    float mMu;                                 // GRAVITY * central mass
+    // position = A * cos(E) + B * sin(E) + C
+    std::vector<float> mAX, mAY, mAZ;
+    std::vector<float> mBX, mBY, mBZ;
+    std::vector<float> mCX, mCY, mCZ;
+    std::vector<float> mE;
+    std::vector<double> mM0, mN;               // phase is kept in double, t grows without bound
+    size_t mCount = 0;
+
+    void ScalarRange(double t, size_t begin, size_t end, float *x, float *y, float *z) const;
+    void AVX2Range(double t, size_t begin, size_t end, float *x, float *y, float *z) const;
+    void ScalarGather(const uint32_t *indices, const double *t, size_t begin, size_t end,
+                      float *x, float *y, float *z, float *vx, float *vy, float *vz) const;
+    void AVX2Gather(const uint32_t *indices, const double *t, size_t begin, size_t end,
+                    float *x, float *y, float *z, float *vx, float *vy, float *vz) const;
+public:
+    explicit KeplerOrbits(float centralMass);
+    ~KeplerOrbits();
+
+    inline size_t Size() const { return this->mCount; }
+    // hash of the central mass and every orbit, changes with any of their elements
+    uint64_t Key() const;
+
+    size_t Add(const OrbitalElements &elements);
+    // single orbit position and velocity relative to the central body
+    void State(size_t i, double t, glm::vec3 &position, glm::vec3 &velocity) const;
+    // positions of all orbits at time t into x/y/z[0 .. Size()), relative to the central body
+    void Propagate(double t, float *x, float *y, float *z, Path path = Path::AVX2) const;
+    // positions of bodies [first, first + Size()) around focus
+    void Propagate(double t, Bodies &bodies, size_t first, const glm::vec3 &focus, Path path = Path::AVX2) const;
+    // states of the orbits indices[0 .. count), each at its own time t[k], into x/y/z and vx/vy/vz[0 .. count)
+    // relative to the central body; for scattered orbits such as those a staggered update has due
+    void Propagate(const uint32_t *indices, const double *t, size_t count, float *x, float *y, float *z,
+                   float *vx, float *vy, float *vz, Path path = Path::AVX2) const;
+};
+
+
+#endif //PROJECT_KEPLERORBITS_H
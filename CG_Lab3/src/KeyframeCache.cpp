@@ -0,0 +1,188 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "KeyframeCache.h"
+
+#include <cmath>
+#include <cstring>
+
+// neighbouring intervals searched for a keyframe, long frames leave some of them empty
+#define KEYFRAME_SEARCH 4
+
+static inline int64_t FloorDiv(int64_t a, int64_t b)
+{
+    return a / b - (a % b != 0 && (a < 0) != (b < 0) ? 1 : 0);
+}
+
+KeyframeCache::KeyframeCache(double interval, size_t perSegment, size_t capacity)
+        : mInterval(interval), mPerSegment(perSegment), mCapacity(capacity) {}
+
+KeyframeCache::Segment *KeyframeCache::Find(int64_t segment) {
+    auto it = this->mSegments.find(segment);
+    if (it == this->mSegments.end())
+        return nullptr;
+    this->mLru.splice(this->mLru.begin(), this->mLru, it->second.lru);
+    return &it->second;
+}
+
+bool KeyframeCache::Keyframe(int64_t slot, Segment *&segment, size_t &index) {
+    int64_t id = FloorDiv(slot, int64_t(this->mPerSegment));
+    index = size_t(slot - id * int64_t(this->mPerSegment));
+    segment = this->Find(id);
+    return segment != nullptr && std::isfinite(segment->times[index]);
+}
+
+bool KeyframeCache::Latest(double time, Segment *&segment, size_t &index) {
+    int64_t slot = int64_t(std::floor(time / this->mInterval));
+    for (int64_t s = slot; s > slot - KEYFRAME_SEARCH; --s)
+        if (this->Keyframe(s, segment, index) && segment->times[index] <= time)
+            return true;
+    return false;
+}
+
+bool KeyframeCache::Earliest(double time, Segment *&segment, size_t &index) {
+    int64_t slot = int64_t(std::floor(time / this->mInterval));
+    for (int64_t s = slot; s < slot + KEYFRAME_SEARCH; ++s)
+        if (this->Keyframe(s, segment, index) && segment->times[index] > time)
+            return true;
+    return false;
+}
+
+bool KeyframeCache::Record(double time, const Bodies &bodies) {
+    size_t n = bodies.Size();
+    if (!this->mSegments.empty() && this->mSegments.begin()->second.bodies != n)
+        this->Clear();
+
+    int64_t slot = int64_t(std::floor(time / this->mInterval));
+    int64_t id = FloorDiv(slot, int64_t(this->mPerSegment));
+    size_t index = size_t(slot - id * int64_t(this->mPerSegment));
+    Segment *segment = this->Find(id);
+    if (segment == nullptr) {
+        size_t bytes = this->mPerSegment * (COLUMNS * n * sizeof(float) + sizeof(double));
+        while (!this->mLru.empty() && this->mStats.bytes + bytes > this->mCapacity)
+        {
+            Segment &old = this->mSegments[this->mLru.back()];
+            for (double t : old.times)
+                this->mStats.keyframes -= std::isfinite(t) ? 1 : 0;
+            this->mSegments.erase(this->mLru.back());
+            this->mLru.pop_back();
+            this->mStats.bytes -= bytes;
+            --this->mStats.segments;
+            ++this->mStats.evictions;
+        }
+        this->mLru.push_front(id);
+        segment = &this->mSegments[id];
+        segment->bodies = n;
+        segment->times.assign(this->mPerSegment, -INFINITY);
+        segment->columns.resize(COLUMNS * this->mPerSegment * n);
+        segment->lru = this->mLru.begin();
+        this->mStats.bytes += bytes;
+        ++this->mStats.segments;
+    }
+    if (std::isfinite(segment->times[index]))
+        return false;
+
+    const std::vector<float> *sources[COLUMNS] = { &bodies.x, &bodies.y, &bodies.z, &bodies.vx, &bodies.vy, &bodies.vz };
+    for (int c = 0; c < COLUMNS; ++c)
+        std::memcpy(this->Column(*segment, c, index), sources[c]->data(), n * sizeof(float));
+    segment->times[index] = time;
+    ++this->mStats.keyframes;
+    return true;
+}
+
+bool KeyframeCache::Interpolate(double time, Bodies &bodies) {
+    Segment *s0, *s1;
+    size_t i0, i1;
+    if (!this->Latest(time, s0, i0) || !this->Earliest(time, s1, i1) || s0->bodies != bodies.Size()) {
+        ++this->mStats.misses;
+        return false;
+    }
+    ++this->mStats.hits;
+
+    size_t n = bodies.Size();
+    double t0 = s0->times[i0], t1 = s1->times[i1];
+    float h = float(t1 - t0), s = float((time - t0) / (t1 - t0));
+    float s2 = s * s, s3 = s2 * s;
+    // cubic Hermite basis and its derivative, tangents scaled by the keyframe distance
+    float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f, h10 = (s3 - 2.0f * s2 + s) * h;
+    float h01 = -2.0f * s3 + 3.0f * s2, h11 = (s3 - s2) * h;
+    float d00 = (6.0f * s2 - 6.0f * s) / h, d10 = 3.0f * s2 - 4.0f * s + 1.0f;
+    float d01 = (-6.0f * s2 + 6.0f * s) / h, d11 = 3.0f * s2 - 2.0f * s;
+    std::vector<float> *positions[3] = { &bodies.x, &bodies.y, &bodies.z };
+    std::vector<float> *velocities[3] = { &bodies.vx, &bodies.vy, &bodies.vz };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float *p0 = this->Column(*s0, axis, i0), *v0 = this->Column(*s0, axis + 3, i0);
+        const float *p1 = this->Column(*s1, axis, i1), *v1 = this->Column(*s1, axis + 3, i1);
+        float *p = positions[axis]->data(), *v = velocities[axis]->data();
+        for (size_t i = 0; i < n; ++i)
+        {
+            p[i] = h00 * p0[i] + h10 * v0[i] + h01 * p1[i] + h11 * v1[i];
+            v[i] = d00 * p0[i] + d10 * v0[i] + d01 * p1[i] + d11 * v1[i];
+        }
+    }
+    return true;
+}
+
+bool KeyframeCache::Nearest(double time, Bodies &bodies, double &keyTime) {
+    Segment *segment = nullptr;
+    size_t index = 0;
+    if (!this->Latest(time, segment, index)) {
+        // a gap left by an eviction or by long frames, look through everything
+        segment = nullptr;
+        int64_t id = 0;
+        for (auto &entry : this->mSegments)
+            for (size_t k = 0; k < this->mPerSegment; ++k)
+            {
+                double t = entry.second.times[k];
+                if (std::isfinite(t) && t <= time && (segment == nullptr || t > segment->times[index])) {
+                    segment = &entry.second;
+                    index = k;
+                    id = entry.first;
+                }
+            }
+        if (segment == nullptr)
+            return false;
+        this->Find(id);
+    }
+    if (segment->bodies != bodies.Size())
+        return false;
+
+    std::vector<float> *targets[COLUMNS] = { &bodies.x, &bodies.y, &bodies.z, &bodies.vx, &bodies.vy, &bodies.vz };
+    for (int c = 0; c < COLUMNS; ++c)
+        std::memcpy(targets[c]->data(), this->Column(*segment, c, index), segment->bodies * sizeof(float));
+    keyTime = segment->times[index];
+    return true;
+}
+
+void KeyframeCache::Truncate(double time) {
+    for (auto it = this->mSegments.begin(); it != this->mSegments.end(); )
+    {
+        size_t left = 0;
+        for (double &t : it->second.times)
+        {
+            if (std::isfinite(t) && t > time) {
+                t = -INFINITY;
+                --this->mStats.keyframes;
+            }
+            left += std::isfinite(t) ? 1 : 0;
+        }
+        if (left > 0) {
+            ++it;
+            continue;
+        }
+        this->mStats.bytes -= this->mPerSegment * (COLUMNS * it->second.bodies * sizeof(float) + sizeof(double));
+        --this->mStats.segments;
+        this->mLru.erase(it->second.lru);
+        it = this->mSegments.erase(it);
+    }
+}
+
+void KeyframeCache::Clear() {
+    this->mSegments.clear();
+    this->mLru.clear();
+    this->mStats.segments = 0;
+    this->mStats.bytes = 0;
+    this->mStats.keyframes = 0;
+}
@@ -0,0 +1,78 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_KEYFRAMECACHE_H
+#define PROJECT_KEYFRAMECACHE_H
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "Bodies.h"
+
+
+// body states at regular intervals of simulated time, for going back in time without integrating.
+// keyframes are kept in segments of columns (x, y, z, vx, vy, vz, each over all bodies);
+// when the memory cap is reached the least recently used segment goes
+class KeyframeCache {
+public:
+    struct Stats
+    {
+        size_t segments;
+        size_t bytes;
+        size_t keyframes;
+        size_t hits;                 // interpolations from two cached keyframes
+        size_t misses;
+        size_t evictions;
+    };
+private:
+    static const int COLUMNS = 6;
+
+    struct Segment
+    {
+        size_t bodies;
+        std::vector<double> times;        // per keyframe, negative infinity while empty
+        std::vector<float> columns;       // [COLUMNS][keyframes per segment][bodies]
+        std::list<int64_t>::iterator lru;
+    };
+
+    double mInterval;
+    size_t mPerSegment;
+    size_t mCapacity;
+    std::unordered_map<int64_t, Segment> mSegments;
+    std::list<int64_t> mLru;              // most recently used first
+    Stats mStats = {};
+
+    Segment *Find(int64_t segment);
+    // keyframe of the interval slot, false when there is none
+    bool Keyframe(int64_t slot, Segment *&segment, size_t &index);
+    bool Latest(double time, Segment *&segment, size_t &index);
+    bool Earliest(double time, Segment *&segment, size_t &index);
+    inline const float *Column(const Segment &segment, int column, size_t index) const {
+        return &segment.columns[(size_t(column) * this->mPerSegment + index) * segment.bodies];
+    }
+    inline float *Column(Segment &segment, int column, size_t index) const {
+        return &segment.columns[(size_t(column) * this->mPerSegment + index) * segment.bodies];
+    }
+public:
+    // one keyframe per interval, perSegment of them per segment, at most capacity bytes of segments
+    KeyframeCache(double interval, size_t perSegment, size_t capacity);
+
+    // keeps the state if its interval has no keyframe yet; a different body count starts a new history
+    bool Record(double time, const Bodies &bodies);
+    // positions and velocities at time by cubic Hermite interpolation of the keyframes around it,
+    // false when either of them is missing
+    bool Interpolate(double time, Bodies &bodies);
+    // state of the latest keyframe at or before time and its time, to integrate onwards from
+    bool Nearest(double time, Bodies &bodies, double &keyTime);
+    // forgets the keyframes after time, e.g. when the history is rewritten from there
+    void Truncate(double time);
+    void Clear();
+
+    inline double getInterval() const { return this->mInterval; }
+    inline const Stats &getStats() const { return this->mStats; }
+};
+
+
+#endif //PROJECT_KEYFRAMECACHE_H
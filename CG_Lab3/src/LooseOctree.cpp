@@ -0,0 +1,325 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "LooseOctree.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <queue>
+
+// a depth-first walk holds at most 7 siblings per level plus the current node
+#define OCTREE_STACK (8 * (OCTREE_MAX_DEPTH + 1))
+
+Frustum::Frustum(const glm::mat4 &clip) {
+    // Gribb-Hartmann: rows of the clip matrix added to or subtracted from the w row
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+        row[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+    for (int i = 0; i < 3; ++i)
+    {
+        this->planes[2*i] = row[3] + row[i];
+        this->planes[2*i + 1] = row[3] - row[i];
+    }
+    for (glm::vec4 &plane : this->planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+LooseOctree::LooseOctree(const glm::vec3 &centre, float halfSize, int maxDepth)
+        : mCentre(centre), mHalfSize(halfSize), mMaxDepth(std::max(0, std::min(maxDepth, OCTREE_MAX_DEPTH))) {
+    this->mRoot = this->mNodePool.Allocate(Node{ centre, halfSize, 0, 0, nullptr, {}, nullptr });
+}
+
+LooseOctree::~LooseOctree() {
+    this->Clear();
+    this->mNodePool.Free(this->mRoot);
+}
+
+void LooseOctree::ResetStats() {
+    for (Stats &stats : this->mStats)
+        stats = Stats{};
+}
+
+// deepest level whose cell half size still covers the radius, so the loose bounds hold the sphere
+int LooseOctree::TargetDepth(const glm::vec3 &centre, float radius) const {
+    glm::vec3 offset = glm::abs(centre - this->mCentre);
+    if (offset.x > this->mHalfSize || offset.y > this->mHalfSize || offset.z > this->mHalfSize)
+        return 0;
+    if (radius <= 0.0f)
+        return this->mMaxDepth;
+    int depth = int(std::floor(std::log2(this->mHalfSize / radius)));
+    return std::max(0, std::min(depth, this->mMaxDepth));
+}
+
+bool LooseOctree::InCell(const Node *node, const glm::vec3 &centre) const {
+    if (node == this->mRoot)
+        return true;
+    glm::vec3 offset = glm::abs(centre - node->centre);
+    return offset.x <= node->halfSize && offset.y <= node->halfSize && offset.z <= node->halfSize;
+}
+
+void LooseOctree::Link(Item *item) {
+    int depth = this->TargetDepth(item->centre, item->radius);
+    Node *node = this->mRoot;
+    ++node->subtree;
+    while (node->depth < depth)
+    {
+        int child = (item->centre.x >= node->centre.x ? 1 : 0)
+                  | (item->centre.y >= node->centre.y ? 2 : 0)
+                  | (item->centre.z >= node->centre.z ? 4 : 0);
+        if (node->children[child] == nullptr) {
+            float half = node->halfSize * 0.5f;
+            glm::vec3 centre = node->centre + glm::vec3(child & 1 ? half : -half,
+                                                         child & 2 ? half : -half,
+                                                         child & 4 ? half : -half);
+            node->children[child] = this->mNodePool.Allocate(Node{ centre, half, node->depth + 1, 0, node, {}, nullptr });
+        }
+        node = node->children[child];
+        ++node->subtree;
+    }
+
+    item->node = node;
+    item->prev = nullptr;
+    item->next = node->items;
+    if (node->items != nullptr)
+        node->items->prev = item;
+    node->items = item;
+}
+
+void LooseOctree::Unlink(Item *item) {
+    Node *node = item->node;
+    if (item->prev != nullptr)
+        item->prev->next = item->next;
+    else
+        node->items = item->next;
+    if (item->next != nullptr)
+        item->next->prev = item->prev;
+
+    // bottom-up, so a child is released before its parent is looked at
+    while (node != nullptr)
+    {
+        Node *parent = node->parent;
+        if (--node->subtree == 0 && node != this->mRoot) {
+            for (Node *&child : parent->children)
+                if (child == node)
+                    child = nullptr;
+            this->mNodePool.Free(node);
+        }
+        node = parent;
+    }
+}
+
+void LooseOctree::Insert(uint32_t id, const glm::vec3 &centre, float radius) {
+    if (this->Contains(id)) {
+        this->Move(id, centre, radius);
+        return;
+    }
+    if (id >= this->mItems.size())
+        this->mItems.resize(id + 1, nullptr);
+    Item *item = this->mItemPool.Allocate(Item{ id, centre, radius, nullptr, nullptr, nullptr });
+    this->mItems[id] = item;
+    this->Link(item);
+    ++this->mCount;
+}
+
+void LooseOctree::Remove(uint32_t id) {
+    if (!this->Contains(id))
+        return;
+    Item *item = this->mItems[id];
+    this->Unlink(item);
+    this->mItemPool.Free(item);
+    this->mItems[id] = nullptr;
+    --this->mCount;
+}
+
+void LooseOctree::Move(uint32_t id, const glm::vec3 &centre, float radius) {
+    if (!this->Contains(id)) {
+        this->Insert(id, centre, radius);
+        return;
+    }
+    Item *item = this->mItems[id];
+    // most frames a body stays inside its cell and only the sphere changes
+    if (this->TargetDepth(centre, radius) == item->node->depth && this->InCell(item->node, centre)) {
+        item->centre = centre;
+        item->radius = radius;
+        return;
+    }
+    this->Unlink(item);
+    item->centre = centre;
+    item->radius = radius;
+    this->Link(item);
+}
+
+void LooseOctree::FreeSubtree(Node *node) {
+    for (Node *&child : node->children)
+        if (child != nullptr) {
+            this->FreeSubtree(child);
+            this->mNodePool.Free(child);
+            child = nullptr;
+        }
+    for (Item *item = node->items; item != nullptr; )
+    {
+        Item *next = item->next;
+        this->mItemPool.Free(item);
+        item = next;
+    }
+    node->items = nullptr;
+    node->subtree = 0;
+}
+
+void LooseOctree::Clear() {
+    this->FreeSubtree(this->mRoot);
+    this->mItems.clear();
+    this->mCount = 0;
+}
+
+float LooseOctree::LooseDistance2(const Node *node, const glm::vec3 &point) const {
+    if (node == this->mRoot)
+        return 0.0f;
+    glm::vec3 d = glm::max(glm::abs(point - node->centre) - glm::vec3(2.0f * node->halfSize), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+void LooseOctree::CollectSubtree(const Node *node, std::vector<uint32_t> &out, Stats &stats) const {
+    ++stats.nodesVisited;
+    for (const Item *item = node->items; item != nullptr; item = item->next)
+        out.push_back(item->id);
+    for (const Node *child : node->children)
+        if (child != nullptr)
+            this->CollectSubtree(child, out, stats);
+}
+
+void LooseOctree::QuerySphere(const glm::vec3 &centre, float radius, std::vector<uint32_t> &out) {
+    auto start = std::chrono::steady_clock::now();
+    Stats &stats = this->mStats[int(OctreeQuery::SPHERE)];
+    size_t found = out.size();
+
+    const Node *stack[OCTREE_STACK];
+    int top = 0;
+    stack[top++] = this->mRoot;
+    while (top > 0)
+    {
+        const Node *node = stack[--top];
+        ++stats.nodesVisited;
+        for (const Item *item = node->items; item != nullptr; item = item->next)
+        {
+            ++stats.itemsTested;
+            glm::vec3 d = item->centre - centre;
+            float r = item->radius + radius;
+            if (glm::dot(d, d) <= r * r)
+                out.push_back(item->id);
+        }
+        for (const Node *child : node->children)
+            if (child != nullptr && this->LooseDistance2(child, centre) <= radius * radius)
+                stack[top++] = child;
+    }
+
+    ++stats.queries;
+    stats.itemsFound += out.size() - found;
+    stats.ms += Milliseconds(start);
+}
+
+void LooseOctree::QueryFrustum(const Frustum &frustum, std::vector<uint32_t> &out) {
+    auto start = std::chrono::steady_clock::now();
+    Stats &stats = this->mStats[int(OctreeQuery::FRUSTUM)];
+    size_t found = out.size();
+
+    const Node *stack[OCTREE_STACK];
+    int top = 0;
+    stack[top++] = this->mRoot;
+    while (top > 0)
+    {
+        const Node *node = stack[--top];
+        ++stats.nodesVisited;
+        for (const Item *item = node->items; item != nullptr; item = item->next)
+        {
+            ++stats.itemsTested;
+            bool inside = true;
+            for (const glm::vec4 &plane : frustum.planes)
+                if (glm::dot(glm::vec3(plane), item->centre) + plane.w < -item->radius) {
+                    inside = false;
+                    break;
+                }
+            if (inside)
+                out.push_back(item->id);
+        }
+
+        for (const Node *child : node->children)
+        {
+            if (child == nullptr)
+                continue;
+            // loose box against every plane: outside one rejects it, inside all takes the subtree untested
+            float extent = 2.0f * child->halfSize;
+            bool outside = false, contained = true;
+            for (const glm::vec4 &plane : frustum.planes)
+            {
+                float distance = glm::dot(glm::vec3(plane), child->centre) + plane.w;
+                float reach = extent * (std::fabs(plane.x) + std::fabs(plane.y) + std::fabs(plane.z));
+                if (distance < -reach) {
+                    outside = true;
+                    break;
+                }
+                if (distance < reach)
+                    contained = false;
+            }
+            if (outside)
+                continue;
+            if (contained)
+                this->CollectSubtree(child, out, stats);
+            else
+                stack[top++] = child;
+        }
+    }
+
+    ++stats.queries;
+    stats.itemsFound += out.size() - found;
+    stats.ms += Milliseconds(start);
+}
+
+// best first over nodes ordered by the distance to their loose bounds
+bool LooseOctree::Nearest(const glm::vec3 &point, uint32_t &id, float &distance, uint32_t exclude) {
+    auto start = std::chrono::steady_clock::now();
+    Stats &stats = this->mStats[int(OctreeQuery::NEAREST)];
+    typedef std::pair<float, const Node *> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    open.emplace(0.0f, this->mRoot);
+    float best = INFINITY;
+    bool found = false;
+
+    while (!open.empty())
+    {
+        Entry entry = open.top();
+        open.pop();
+        if (entry.first > best * best)
+            break;
+        const Node *node = entry.second;
+        ++stats.nodesVisited;
+        for (const Item *item = node->items; item != nullptr; item = item->next)
+        {
+            if (item->id == exclude)
+                continue;
+            ++stats.itemsTested;
+            float d = std::max(glm::length(item->centre - point) - item->radius, 0.0f);
+            if (d < best) {
+                best = d;
+                id = item->id;
+                found = true;
+            }
+        }
+        for (const Node *child : node->children)
+            if (child != nullptr) {
+                // surfaces lie inside the loose bounds, so this never overestimates
+                float d2 = this->LooseDistance2(child, point);
+                if (d2 <= best * best)
+                    open.emplace(d2, child);
+            }
+    }
+
+    distance = best;
+    ++stats.queries;
+    stats.itemsFound += found ? 1 : 0;
+    stats.ms += Milliseconds(start);
+    return found;
+}
@@ -0,0 +1,111 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_LOOSEOCTREE_H
+#define PROJECT_LOOSEOCTREE_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Pool.h"
+
+// hard limit on the depth, the stack of the queries is sized for it
+#define OCTREE_MAX_DEPTH 16
+
+enum class OctreeQuery
+{
+    SPHERE, FRUSTUM, NEAREST
+};
+
+// six inward facing planes, ax + by + cz + d >= 0 inside
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    // planes of a projection * view matrix
+    explicit Frustum(const glm::mat4 &clip);
+};
+
+
+// loose octree (loose factor 2) over bounding spheres with nodes and items from pools
+class LooseOctree {
+public:
+    struct Stats
+    {
+        size_t queries;
+        size_t nodesVisited;
+        size_t itemsTested;
+        size_t itemsFound;
+        double ms;
+    };
+private:
+    struct Node;
+    struct Item
+    {
+        uint32_t id;
+        glm::vec3 centre;
+        float radius;
+        Node *node;
+        Item *prev, *next;
+    };
+    struct Node
+    {
+        glm::vec3 centre;
+        float halfSize;           // of the cell, the loose bounds are twice as large
+        int depth;
+        uint32_t subtree;         // items in this node and below, empty nodes go back to the pool
+        Node *parent;
+        Node *children[8];
+        Item *items;
+    };
+
+    glm::vec3 mCentre;
+    float mHalfSize;
+    int mMaxDepth;
+    Pool<Node> mNodePool;
+    Pool<Item> mItemPool;
+    Node *mRoot;
+    std::vector<Item *> mItems;               // by id
+    size_t mCount = 0;
+    Stats mStats[3] = {};
+
+    int TargetDepth(const glm::vec3 &centre, float radius) const;
+    bool InCell(const Node *node, const glm::vec3 &centre) const;
+    void Link(Item *item);
+    void Unlink(Item *item);
+    void FreeSubtree(Node *node);
+    void CollectSubtree(const Node *node, std::vector<uint32_t> &out, Stats &stats) const;
+    // squared distance from a point to the loose bounds, 0 for the unbounded root
+    float LooseDistance2(const Node *node, const glm::vec3 &point) const;
+public:
+    // cube of the given centre and half size; bodies outside it stay in the root.
+    // small bodies share cells of the deepest level instead of getting a chain of nodes each
+    LooseOctree(const glm::vec3 &centre, float halfSize, int maxDepth = 8);
+    ~LooseOctree();
+    LooseOctree(const LooseOctree &) = delete;
+    LooseOctree &operator=(const LooseOctree &) = delete;
+
+    inline size_t Size() const { return this->mCount; }
+    inline bool Contains(uint32_t id) const { return id < this->mItems.size() && this->mItems[id] != nullptr; }
+    inline size_t getNodeCount() const { return this->mNodePool.getLive(); }
+    inline size_t getNodeCapacity() const { return this->mNodePool.getCapacity(); }
+    inline const Stats &getStats(OctreeQuery query) const { return this->mStats[int(query)]; }
+    void ResetStats();
+
+    void Insert(uint32_t id, const glm::vec3 &centre, float radius);
+    void Remove(uint32_t id);
+    // stays in place when the sphere still fits its node, otherwise relinks
+    void Move(uint32_t id, const glm::vec3 &centre, float radius);
+    void Clear();
+
+    // ids of the spheres overlapping the query sphere, appended to out
+    void QuerySphere(const glm::vec3 &centre, float radius, std::vector<uint32_t> &out);
+    // ids of the spheres at least partly inside the frustum, appended to out
+    void QueryFrustum(const Frustum &frustum, std::vector<uint32_t> &out);
+    // sphere with the closest surface to point, skipping id exclude; false when there is none
+    bool Nearest(const glm::vec3 &point, uint32_t &id, float &distance, uint32_t exclude = UINT32_MAX);
+};
+
+
+#endif //PROJECT_LOOSEOCTREE_H
@@ -0,0 +1,97 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "NBody.h"
+
+#include <cmath>
+#include <random>
+
+const char *GravityKernelName(GravityKernel kernel)
+{
+    switch (kernel)
+    {
+        case GravityKernel::AUTO :
+            return "auto";
+        case GravityKernel::BARNES_HUT :
+            return "Barnes-Hut";
+        case GravityKernel::DIRECT_SCALAR :
+            return "direct scalar";
+        case GravityKernel::DIRECT_AVX2 :
+            return "direct AVX2";
+    }
+    return "unknown";
+}
+
+NBody::NBody(ThreadPool &pool, float theta) : mTree(pool, theta), mDirect(pool) {
+
+}
+
+NBody::~NBody() {
+
+}
+
+GravityKernel NBody::ActiveKernel() const {
+    if (this->mKernel != GravityKernel::AUTO)
+        return this->mKernel;
+    if (this->mBodies.Size() >= DIRECT_SUM_LIMIT)
+        return GravityKernel::BARNES_HUT;
+    return DirectSum::HasAVX2() ? GravityKernel::DIRECT_AVX2 : GravityKernel::DIRECT_SCALAR;
+}
+
+void NBody::ComputeAccelerations() {
+    this->ComputeAccelerations(this->mBodies);
+}
+
+void NBody::ComputeAccelerations(Bodies &bodies) {
+    switch (this->ActiveKernel())
+    {
+        case GravityKernel::DIRECT_SCALAR :
+            this->mDirect.ComputeAccelerations(bodies, DirectSum::Path::SCALAR);
+            break;
+        case GravityKernel::DIRECT_AVX2 :
+            this->mDirect.ComputeAccelerations(bodies, DirectSum::Path::AVX2);
+            break;
+        default :
+            this->mTree.Build(bodies);
+            this->mTree.ComputeAccelerations(bodies);
+    }
+}
+
+double TotalEnergy(const Bodies &bodies)
+{
+    const double eps2 = double(SOFTENING) * SOFTENING;
+    double kinetic = 0.0, potential = 0.0;
+    for (size_t i = 0; i < bodies.Size(); ++i)
+    {
+        double v2 = double(bodies.vx[i])*bodies.vx[i] + double(bodies.vy[i])*bodies.vy[i] + double(bodies.vz[i])*bodies.vz[i];
+        kinetic += 0.5 * bodies.mass[i] * v2;
+        for (size_t j = i + 1; j < bodies.Size(); ++j)
+        {
+            double dx = double(bodies.x[j]) - bodies.x[i];
+            double dy = double(bodies.y[j]) - bodies.y[i];
+            double dz = double(bodies.z[j]) - bodies.z[i];
+            potential -= GRAVITY * double(bodies.mass[i]) * bodies.mass[j] / std::sqrt(dx*dx + dy*dy + dz*dz + eps2);
+        }
+    }
+    return kinetic + potential;
+}
+
+void AddBelt(Bodies &bodies, size_t central, size_t count, float inner, float outer, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    glm::vec3 center = bodies.Position(central), drift = bodies.Velocity(central);
+    float mu = GRAVITY * bodies.mass[central];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float r = inner + (outer - inner) * unit(rng);
+        float angle = 6.2831853f * unit(rng);
+        float height = 0.02f * r * (unit(rng) - 0.5f);
+        float v = std::sqrt(mu / r);
+        glm::vec3 position(r * std::sin(angle), height, r * std::cos(angle));
+        glm::vec3 velocity(v * std::cos(angle), 0.0f, -v * std::sin(angle));
+        bodies.Add(center + position, drift + velocity, 1e-4f, 0.1f + 0.2f * unit(rng));
+    }
+}
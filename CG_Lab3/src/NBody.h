@@ -0,0 +1,57 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_NBODY_H
+#define PROJECT_NBODY_H
+
+#include "Bodies.h"
+#include "BarnesHut.h"
+#include "DirectSum.h"
+#include "ThreadPool.h"
+
+// below this many bodies AUTO picks the direct sum
+#define DIRECT_SUM_LIMIT 4096
+
+enum class GravityKernel
+{
+    AUTO, BARNES_HUT, DIRECT_SCALAR, DIRECT_AVX2
+};
+
+const char *GravityKernelName(GravityKernel kernel);
+
+
+// self-gravitating set of bodies advanced by a selectable force kernel
+class NBody {
+private:
+    Bodies mBodies;
+    BarnesHut mTree;
+    DirectSum mDirect;
+    GravityKernel mKernel = GravityKernel::AUTO;
+public:
+    explicit NBody(ThreadPool &pool, float theta = 0.5f);
+    ~NBody();
+
+    inline Bodies &getBodies() { return this->mBodies; }
+    inline const Bodies &getBodies() const { return this->mBodies; }
+    inline BarnesHut &getTree() { return this->mTree; }
+
+    inline void setKernel(GravityKernel kernel) { this->mKernel = kernel; }
+    inline GravityKernel getKernel() const { return this->mKernel; }
+    // kernel AUTO resolves to for the current body count
+    GravityKernel ActiveKernel() const;
+
+    // fills the accelerations for the current positions
+    void ComputeAccelerations();
+    // same with the active kernel on another set of bodies
+    void ComputeAccelerations(Bodies &bodies);
+};
+
+// kinetic plus softened potential energy, O(N^2) in double
+double TotalEnergy(const Bodies &bodies);
+
+// adds count light bodies on circular orbits around body central, between radii inner and outer
+void AddBelt(Bodies &bodies, size_t central, size_t count, float inner, float outer, uint32_t seed = 1);
+
+
+#endif //PROJECT_NBODY_H
@@ -0,0 +1,165 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include <glad/glad.h>
+#include "NullGL.h"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static GLuint nextName = 1;
+static std::vector<char> mapped;
+
+// every entry point without a special case: accepts anything, returns zero
+template <typename F>
+struct NullEntry;
+
+template <typename R, typename... A>
+struct NullEntry<R (APIENTRYP)(A...)>
+{
+    static R APIENTRY Call(A...) {
+        return R();
+    }
+};
+
+static void APIENTRY GenNames(GLsizei n, GLuint *names)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        names[i] = nextName++;
+}
+
+static GLuint APIENTRY CreateShader(GLenum type)
+{
+    return nextName++;
+}
+
+static GLuint APIENTRY CreateProgram()
+{
+    return nextName++;
+}
+
+static const GLubyte *APIENTRY GetString(GLenum name)
+{
+    switch (name) {
+        case GL_VERSION: return (const GLubyte *) "4.5 (Core Profile) Null";
+        case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte *) "4.50";
+        case GL_VENDOR: return (const GLubyte *) "none";
+        case GL_RENDERER: return (const GLubyte *) "Null GL";
+        default: return (const GLubyte *) "";
+    }
+}
+
+// the loader gives up on a context without extensions
+static const GLubyte *APIENTRY GetStringi(GLenum name, GLuint index)
+{
+    return (const GLubyte *) "GL_NULL_backend";
+}
+
+static void APIENTRY GetIntegerv(GLenum name, GLint *data)
+{
+    switch (name) {
+        case GL_NUM_EXTENSIONS: *data = 1; break;
+        case GL_MAJOR_VERSION: *data = 4; break;
+        case GL_MINOR_VERSION: *data = 5; break;
+        case GL_MAX_TEXTURE_SIZE: *data = 16384; break;
+        case GL_MAX_VERTEX_ATTRIBS: *data = 16; break;
+        default: *data = 0;
+    }
+}
+
+static void APIENTRY GetIntegeri_v(GLenum name, GLuint index, GLint *data)
+{
+    *data = name == GL_MAX_COMPUTE_WORK_GROUP_SIZE ? 1024 : 0;
+}
+
+static void APIENTRY GetShaderiv(GLuint shader, GLenum name, GLint *data)
+{
+    *data = name == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+static void APIENTRY GetProgramiv(GLuint program, GLenum name, GLint *data)
+{
+    *data = name == GL_LINK_STATUS || name == GL_VALIDATE_STATUS ? GL_TRUE : 0;
+}
+
+static void APIENTRY GetInfoLog(GLuint object, GLsizei size, GLsizei *length, GLchar *log)
+{
+    if (length != nullptr)
+        *length = 0;
+    if (size > 0)
+        log[0] = '\0';
+}
+
+// the same name always gets the same location
+static GLint APIENTRY GetUniformLocation(GLuint program, const GLchar *name)
+{
+    return GLint(std::hash<std::string>()(name) & 0x3FF);
+}
+
+static GLenum APIENTRY CheckFramebufferStatus(GLenum target)
+{
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void APIENTRY GetQueryObjectiv(GLuint id, GLenum name, GLint *data)
+{
+    *data = name == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void APIENTRY GetQueryObjectui64v(GLuint id, GLenum name, GLuint64 *data)
+{
+    *data = 0;
+}
+
+// writes go to scratch memory
+static void *APIENTRY MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    if (mapped.size() < size_t(length))
+        mapped.resize(size_t(length));
+    return mapped.data();
+}
+
+static GLsync APIENTRY FenceSync(GLenum condition, GLbitfield flags)
+{
+    return reinterpret_cast<GLsync>(uintptr_t(nextName++));
+}
+
+static GLenum APIENTRY ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    return GL_ALREADY_SIGNALED;
+}
+
+void *NullGLLoader(const char *name)
+{
+    static std::unordered_map<std::string, void *> entries;
+    if (entries.empty()) {
+#define GL_FUNCTION(function) entries[#function] = (void *) &NullEntry<decltype(glad_##function)>::Call;
+#include "GLFunctions.h"
+#undef GL_FUNCTION
+        for (const char *gen : { "glGenBuffers", "glGenVertexArrays", "glGenTextures", "glGenFramebuffers",
+                                 "glGenRenderbuffers", "glGenQueries", "glGenSamplers" })
+            entries[gen] = (void *) &GenNames;
+        entries["glCreateShader"] = (void *) &CreateShader;
+        entries["glCreateProgram"] = (void *) &CreateProgram;
+        entries["glGetString"] = (void *) &GetString;
+        entries["glGetStringi"] = (void *) &GetStringi;
+        entries["glGetIntegerv"] = (void *) &GetIntegerv;
+        entries["glGetIntegeri_v"] = (void *) &GetIntegeri_v;
+        entries["glGetShaderiv"] = (void *) &GetShaderiv;
+        entries["glGetProgramiv"] = (void *) &GetProgramiv;
+        entries["glGetShaderInfoLog"] = (void *) &GetInfoLog;
+        entries["glGetProgramInfoLog"] = (void *) &GetInfoLog;
+        entries["glGetUniformLocation"] = (void *) &GetUniformLocation;
+        entries["glCheckFramebufferStatus"] = (void *) &CheckFramebufferStatus;
+        entries["glGetQueryObjectiv"] = (void *) &GetQueryObjectiv;
+        entries["glGetQueryObjectui64v"] = (void *) &GetQueryObjectui64v;
+        entries["glMapBufferRange"] = (void *) &MapBufferRange;
+        entries["glFenceSync"] = (void *) &FenceSync;
+        entries["glClientWaitSync"] = (void *) &ClientWaitSync;
+    }
+    auto it = entries.find(name);
+    return it == entries.end() ? nullptr : it->second;
+}
@@ -0,0 +1,14 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_NULLGL_H
+#define PROJECT_NULLGL_H
+
+// loader for gladLoadGLLoader handing out entry points that do nothing: an OpenGL 4.5 "driver" without
+// a GPU or a context, for measuring and counting what the CPU submits. object names come from a counter,
+// shaders compile and link, framebuffers are complete and queries read zero
+void *NullGLLoader(const char *name);
+
+
+#endif //PROJECT_NULLGL_H
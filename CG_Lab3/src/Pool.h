@@ -0,0 +1,62 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_POOL_H
+#define PROJECT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// fixed-size object allocator: blocks of slots that are never moved, freed slots are reused first
+template <typename T, size_t BLOCK = 1024>
+class Pool {
+private:
+    union Slot
+    {
+        Slot *next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> mBlocks;
+    Slot *mFree = nullptr;
+    size_t mLive = 0;
+public:
+    Pool() = default;
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+    // objects still alive are not destroyed, owners free them first
+    ~Pool() = default;
+
+    inline size_t getLive() const { return this->mLive; }
+    inline size_t getCapacity() const { return this->mBlocks.size() * BLOCK; }
+
+    template <typename... Args>
+    T *Allocate(Args &&... args) {
+        if (this->mFree == nullptr) {
+            this->mBlocks.emplace_back(new Slot[BLOCK]);
+            Slot *block = this->mBlocks.back().get();
+            for (size_t i = 0; i < BLOCK; ++i)
+                block[i].next = i + 1 < BLOCK ? &block[i + 1] : nullptr;
+            this->mFree = block;
+        }
+        Slot *slot = this->mFree;
+        this->mFree = slot->next;
+        ++this->mLive;
+        return new (&slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void Free(T *object) {
+        object->~T();
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = this->mFree;
+        this->mFree = slot;
+        --this->mLive;
+    }
+};
+
+
+#endif //PROJECT_POOL_H
@@ -0,0 +1,145 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include <glad/glad.h>
+#include "ProgramCache.h"
+#include "ErrorChecker.h"
+#include "Hash.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static std::string directory;
+static int hits = 0;
+static int misses = 0;
+
+// a separator after each string, so that moving text between two sources changes the key
+static uint64_t HashString(uint64_t hash, const char *data, size_t size)
+{
+    const unsigned char separator = 0xFF;
+    return Fnv1a(Fnv1a(hash, data, size), &separator, 1);
+}
+
+static std::string FilePath(uint64_t key)
+{
+    char name[24];
+    std::snprintf(name, sizeof(name), "/%016" PRIx64 ".bin", key);
+    return directory + name;
+}
+
+void ProgramCache::setDirectory(const std::string &path) {
+    directory = path;
+}
+
+bool ProgramCache::IsEnabled() {
+    if (directory.empty() || !GLAD_GL_VERSION_4_1)
+        return false;
+    GLint formats = 0;
+    GLCall( glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats) );
+    return formats > 0;
+}
+
+uint64_t ProgramCache::Key(std::initializer_list<const std::string *> sources) {
+    uint64_t hash = FNV1A_BASIS;
+    for (const std::string *source : sources)
+        hash = HashString(hash, source->data(), source->size());
+    // a driver update or another GPU invalidates every binary
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const char *value = (const char *) glGetString(name);
+        hash = HashString(hash, value, value != nullptr ? std::strlen(value) : 0);
+    }
+    return hash;
+}
+
+unsigned int ProgramCache::Load(uint64_t key) {
+    if (!IsEnabled())
+        return 0;
+    std::string path = FilePath(key);
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        ++misses;
+        return 0;
+    }
+    ProgramCacheHeader header{};
+    std::vector<char> binary;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) == 0
+              && header.version == PROGRAM_CACHE_VERSION && header.key == key;
+    if (ok) {
+        binary.resize(header.length);
+        ok = std::fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    std::fclose(file);
+
+    GLint linked = GL_FALSE;
+    unsigned int program = 0;
+    if (ok) {
+        GLCall( program = glCreateProgram() );
+        GLCall( glProgramBinary(program, header.format, binary.data(), GLsizei(binary.size())) );
+        GLCall( glGetProgramiv(program, GL_LINK_STATUS, &linked) );
+    }
+    if (linked != GL_TRUE) {
+        // stale or foreign: compile again and let Store replace it
+        std::cout << "Program cache rejected " << path << std::endl;
+        if (program != 0) {
+            GLCall( glDeleteProgram(program) );
+        }
+        unlink(path.c_str());
+        ++misses;
+        return 0;
+    }
+    ++hits;
+    return program;
+}
+
+void ProgramCache::PrepareLink(unsigned int program) {
+    if (IsEnabled()) {
+        GLCall( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+    }
+}
+
+void ProgramCache::Store(uint64_t key, unsigned int program) {
+    if (program == 0 || !IsEnabled())
+        return;
+    GLint linked = GL_FALSE, length = 0;
+    GLCall( glGetProgramiv(program, GL_LINK_STATUS, &linked) );
+    GLCall( glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length) );
+    if (linked != GL_TRUE || length <= 0)
+        return;
+    ProgramCacheHeader header{};
+    std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    std::vector<char> binary(size_t(length), 0);
+    GLsizei written = 0;
+    GLenum format = 0;
+    GLCall( glGetProgramBinary(program, length, &written, &format, binary.data()) );
+    header.format = format;
+    header.length = uint32_t(written);
+
+    // written aside and renamed, a second instance never reads half a file
+    mkdir(directory.c_str(), 0755);
+    std::string path = FilePath(key), temporary = path + ".tmp";
+    FILE *file = std::fopen(temporary.c_str(), "wb");
+    bool ok = file != nullptr && std::fwrite(&header, sizeof(header), 1, file) == 1
+              && std::fwrite(binary.data(), 1, size_t(written), file) == size_t(written);
+    ok = file != nullptr && std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cout << "Failed to write program cache " << path << std::endl;
+        unlink(temporary.c_str());
+    }
+}
+
+int ProgramCache::getHits() {
+    return hits;
+}
+
+int ProgramCache::getMisses() {
+    return misses;
+}
@@ -0,0 +1,50 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_PROGRAMCACHE_H
+#define PROJECT_PROGRAMCACHE_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+#define PROGRAM_CACHE_MAGIC "PRGB"
+#define PROGRAM_CACHE_VERSION 1
+
+// one file per program, named by the key in hex: header, then length bytes of driver binary
+struct ProgramCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;                   // repeated to catch renamed files
+    uint32_t format;                // binaryFormat of glGetProgramBinary
+    uint32_t length;
+};
+
+
+// linked programs kept on disk with glGetProgramBinary, so later launches skip the GLSL compiler.
+// the key covers the sources and the driver; a binary the driver rejects is deleted and compiled again
+class ProgramCache {
+public:
+    // where the binaries go, empty turns the cache off; the directory is created when needed
+    static void setDirectory(const std::string &directory);
+    // a current GL 4.1 context with at least one binary format
+    static bool IsEnabled();
+
+    // FNV-1a over the sources, vendor, renderer and version strings
+    static uint64_t Key(std::initializer_list<const std::string *> sources);
+    // a linked program or 0 on a miss or a rejected binary
+    static unsigned int Load(uint64_t key);
+    // before linking, drivers may drop what is needed to retrieve the binary otherwise
+    static void PrepareLink(unsigned int program);
+    // after a successful link
+    static void Store(uint64_t key, unsigned int program);
+
+    // loads and stores since the start, for the startup report
+    static int getHits();
+    static int getMisses();
+};
+
+
+#endif //PROJECT_PROGRAMCACHE_H
@@ -0,0 +1,61 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Scheduler.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+Scheduler::Scheduler(double frameBudgetMs) : mFrameBudgetMs(frameBudgetMs) {}
+
+size_t Scheduler::Add(const std::string &name, float rate, double budgetMs, std::function<void(float)> update) {
+    float period = rate > 0.0f ? 1.0f / rate : 0.0f;
+    // golden ratio phases spread any number of systems evenly over the period
+    float phase = std::fmod(0.618034f * float(this->mSystems.size()), 1.0f);
+    this->mSystems.push_back(System{ name, period, budgetMs, std::move(update), phase * period, true, Stats{} });
+    return this->mSystems.size() - 1;
+}
+
+void Scheduler::Tick(float dt) {
+    auto start = std::chrono::steady_clock::now();
+    this->mDue.clear();
+    for (size_t i = 0; i < this->mSystems.size(); ++i)
+    {
+        System &system = this->mSystems[i];
+        system.elapsed += dt;
+        if (system.enabled && system.elapsed >= system.period)
+            this->mDue.push_back(i);
+    }
+    // every-frame systems first, then the most overdue
+    std::stable_sort(this->mDue.begin(), this->mDue.end(), [this](size_t a, size_t b) {
+        const System &sa = this->mSystems[a], &sb = this->mSystems[b];
+        float la = sa.period > 0.0f ? sa.elapsed / sa.period : INFINITY;
+        float lb = sb.period > 0.0f ? sb.elapsed / sb.period : INFINITY;
+        return la > lb;
+    });
+
+    double spent = 0.0;
+    for (size_t i : this->mDue)
+    {
+        System &system = this->mSystems[i];
+        // an every-frame system skips one frame at most
+        bool urgent = system.period == 0.0f ? system.elapsed > dt : system.elapsed >= 2.0f * system.period;
+        if (!urgent && spent + system.budgetMs > this->mFrameBudgetMs) {
+            ++system.stats.deferred;
+            continue;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        system.update(system.elapsed);
+        system.stats.lastMs = Milliseconds(begin);
+        system.stats.totalMs += system.stats.lastMs;
+        ++system.stats.runs;
+        spent += this->mDeterministic ? system.budgetMs : system.stats.lastMs;
+        system.elapsed = 0.0f;
+    }
+
+    ++this->mFrame;
+    this->mLastFrameMs = Milliseconds(start);
+}
@@ -0,0 +1,65 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_SCHEDULER_H
+#define PROJECT_SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+// per-frame systems with their own update rates. a system that is due runs unless the frame
+// has already used up its budget; deferred systems go first next frame and never wait a whole period,
+// every-frame systems never skip two frames in a row
+class Scheduler {
+public:
+    struct Stats
+    {
+        size_t runs;
+        size_t deferred;
+        double lastMs;
+        double totalMs;
+    };
+private:
+    struct System
+    {
+        std::string name;
+        float period;                  // seconds, 0 runs every frame
+        double budgetMs;               // expected cost, decides whether it still fits the frame
+        std::function<void(float)> update;
+        float elapsed;                 // since the last run
+        bool enabled;
+        Stats stats;
+    };
+
+    double mFrameBudgetMs;
+    std::vector<System> mSystems;
+    std::vector<size_t> mDue;
+    uint64_t mFrame = 0;
+    double mLastFrameMs = 0.0;
+    bool mDeterministic = false;
+public:
+    explicit Scheduler(double frameBudgetMs);
+
+    // rate in runs per second, 0 for every frame; update gets the seconds since its last run.
+    // systems of the same rate start at different phases so they do not fall on the same frame
+    size_t Add(const std::string &name, float rate, double budgetMs, std::function<void(float)> update);
+    inline void setEnabled(size_t system, bool enabled) { this->mSystems[system].enabled = enabled; }
+    // the frame budget counts the expected cost of each system that ran instead of the measured one,
+    // so that the same frames defer the same systems on any machine, e.g. for a recorded session
+    inline void setDeterministic(bool deterministic) { this->mDeterministic = deterministic; }
+    // runs the systems due after dt seconds
+    void Tick(float dt);
+
+    inline uint64_t getFrame() const { return this->mFrame; }
+    inline double getLastFrameMs() const { return this->mLastFrameMs; }
+    inline size_t Size() const { return this->mSystems.size(); }
+    inline const std::string &getName(size_t system) const { return this->mSystems[system].name; }
+    inline const Stats &getStats(size_t system) const { return this->mSystems[system].stats; }
+};
+
+
+#endif //PROJECT_SCHEDULER_H
@@ -3,26 +3,67 @@
 //
 
 #include "Shader.h"
+#include "ProgramCache.h"
+#include "ShaderBatch.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
 
-static struct ShaderProgramSource ParseShader(const std::string& filepath)
+// appends the file to lines with every #include "file" replaced by that file, relative to the includer
+static bool Expand(const std::string &path, std::vector<std::string> &lines, std::vector<std::string> &files, int depth)
 {
+    if (depth > SHADER_INCLUDE_DEPTH)
+    {
+        std::cout << "Failed to include " << path << ", includes nested too deep" << std::endl;
+        return false;
+    }
+    std::ifstream stream(path);
+    if (!stream.is_open())
+    {
+        std::cout << "Cannot open source file " << path << std::endl;
+        return false;
+    }
+    files.push_back(path);
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    std::string line;
+    bool ok = true;
+    while (getline(stream, line))
+    {
+        size_t directive = line.find_first_not_of(" \t");
+        if (directive != std::string::npos && line.compare(directive, 8, "#include") == 0)
+        {
+            size_t open = line.find('"'), close = line.rfind('"');
+            if (open == std::string::npos || close <= open)
+            {
+                std::cout << "Malformed " << line << " in " << path << std::endl;
+                ok = false;
+                continue;
+            }
+            ok = Expand(directory + line.substr(open + 1, close - open - 1), lines, files, depth + 1) && ok;
+        }
+        else
+        {
+            lines.push_back(line);
+        }
+    }
+    return ok;
+}
+
+struct ShaderProgramSource Shader::Parse(const std::string& filepath) {
     enum class ShaderType
     {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
+        NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
     };
 
-    std::ifstream stream(filepath);
-    if (!stream.is_open())
-        std::cout << "Cannot open source file!" << std::endl;
-    std::string line;
-    std::stringstream ss[2];
+    std::vector<std::string> lines, files;
+    Expand(filepath, lines, files, 0);
+    std::stringstream ss[3];
     ShaderType type = ShaderType::NONE;
 
-    while (getline(stream, line))
+    for (const std::string &line : lines)
     {
         if (line.find("#shader") != std::string::npos)
         {
@@ -30,14 +71,48 @@ static struct ShaderProgramSource ParseShader(const std::string& filepath)
                 type = ShaderType::VERTEX;
             else if (line.find("fragment") != std::string::npos)
                 type = ShaderType::FRAGMENT;
+            else if (line.find("compute") != std::string::npos)
+                type = ShaderType::COMPUTE;
         }
-        else
+        else if (type != ShaderType::NONE)
         {
             ss[(int)type] << line << '\n';
         }
     }
 
-    return { ss[0].str(), ss[1].str() };
+    return { ss[0].str(), ss[1].str(), ss[2].str(), files };
+}
+
+// "NAME" or "NAME=value" as #define lines right after #version, which has to stay first
+static std::string Define(const std::string &source, const std::vector<std::string> &defines)
+{
+    if (source.empty() || defines.empty())
+        return source;
+    std::string lines;
+    for (const std::string &define : defines)
+    {
+        size_t equals = define.find('=');
+        lines += "#define " + (equals == std::string::npos ? define : define.substr(0, equals) + " " + define.substr(equals + 1)) + "\n";
+    }
+    size_t version = source.find("#version");
+    size_t end = version == std::string::npos ? 0 : source.find('\n', version);
+    end = end == std::string::npos ? source.size() : end + (version == std::string::npos ? 0 : 1);
+    return source.substr(0, end) + lines + source.substr(end);
+}
+
+static const char* ShaderTypeName(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_VERTEX_SHADER :
+            return "vertex";
+        case GL_FRAGMENT_SHADER :
+            return "fragment";
+        case GL_COMPUTE_SHADER :
+            return "compute";
+        default :
+            return "unknown";
+    }
 }
 
 static unsigned int CompileShader(unsigned int type, const std::string& source)
@@ -50,7 +125,7 @@ static unsigned int CompileShader(unsigned int type, const std::string& source)
     // Error handling
     int result;
     GLCall( glGetShaderiv(id, GL_COMPILE_STATUS, &result) );
-    std::cout << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader compile status: " << result << std::endl;
+    std::cout << ShaderTypeName(type) << " shader compile status: " << result << std::endl;
     if ( result == GL_FALSE )
     {
         int length;
@@ -59,7 +134,7 @@ static unsigned int CompileShader(unsigned int type, const std::string& source)
         GLCall( glGetShaderInfoLog(id, length, &length, message) );
         std::cout
                 << "Failed to compile "
-                << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                << ShaderTypeName(type)
                 << "shader"
                 << std::endl;
         std::cout << message << std::endl;
@@ -70,16 +145,9 @@ static unsigned int CompileShader(unsigned int type, const std::string& source)
     return id;
 }
 
-static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+static unsigned int LinkProgram(unsigned int program)
 {
-    // create a shader program
-    unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    GLCall( glAttachShader(program, vs) );
-    GLCall( glAttachShader(program, fs) );
-
+    ProgramCache::PrepareLink(program);
     GLCall( glLinkProgram(program) );
 
     GLint program_linked;
@@ -93,31 +161,310 @@ static unsigned int CreateShader(const std::string& vertexShader, const std::str
         GLCall( glGetProgramInfoLog(program, 1024, &log_length, message) );
         std::cout << "Failed to link program" << std::endl;
         std::cout << message << std::endl;
+        GLCall( glDeleteProgram(program) );
+        return 0;
     }
 
     GLCall( glValidateProgram(program) );
 
+    return program;
+}
+
+static unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+{
+    // create a shader program
+    unsigned int program = glCreateProgram();
+    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
+    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    if (vs == 0 || fs == 0)
+    {
+        GLCall( glDeleteShader(vs) );
+        GLCall( glDeleteShader(fs) );
+        GLCall( glDeleteProgram(program) );
+        return 0;
+    }
+
+    GLCall( glAttachShader(program, vs) );
+    GLCall( glAttachShader(program, fs) );
+
+    program = LinkProgram(program);
+
     GLCall( glDeleteShader(vs) );
     GLCall( glDeleteShader(fs) );
 
     return program;
 }
 
-Shader::Shader(const std::string &path) {
-    this->source = ParseShader(path);
-    std::cout << "VERTEX " << this->mID << std::endl << this->source.VertexSource << std::endl;
-    std::cout << "FRAGMENT " << this->mID << std::endl << this->source.FragmentSource << std::endl;
-    this->mID = CreateShader(this->source.VertexSource, this->source.FragmentSource);
+static unsigned int CreateComputeShader(const std::string& computeShader)
+{
+    // compute programs need GL 4.3
+    if (!GLAD_GL_VERSION_4_3)
+    {
+        std::cout << "Compute shaders need OpenGL 4.3" << std::endl;
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    unsigned int cs = CompileShader(GL_COMPUTE_SHADER, computeShader);
+    if (cs == 0)
+    {
+        GLCall( glDeleteProgram(program) );
+        return 0;
+    }
+
+    GLCall( glAttachShader(program, cs) );
+
+    program = LinkProgram(program);
+
+    GLCall( glDeleteShader(cs) );
+
+    return program;
+}
+
+static ShaderProgramSource Defined(const ShaderProgramSource &parsed, const std::vector<std::string> &defines)
+{
+    return { Define(parsed.VertexSource, defines), Define(parsed.FragmentSource, defines),
+             Define(parsed.ComputeSource, defines), parsed.Files };
+}
+
+static uint64_t CacheKey(const ShaderProgramSource &source)
+{
+    return ProgramCache::Key({ &source.VertexSource, &source.FragmentSource, &source.ComputeSource });
+}
+
+// from the cache or compiled and stored, 0 when compiling or linking fails
+static unsigned int BuildProgram(const ShaderProgramSource &parsed, const std::vector<std::string> &defines,
+                                 const std::string &path)
+{
+    ShaderProgramSource source = Defined(parsed, defines);
+    uint64_t key = CacheKey(source);
+    unsigned int program = ProgramCache::Load(key);
+    if (program != 0) {
+        std::cout << "Program " << path << " from cache" << std::endl;
+        return program;
+    }
+    if (!source.ComputeSource.empty()) {
+        std::cout << "COMPUTE " << path << std::endl << source.ComputeSource << std::endl;
+        program = CreateComputeShader(source.ComputeSource);
+    } else {
+        std::cout << "VERTEX " << path << std::endl << source.VertexSource << std::endl;
+        std::cout << "FRAGMENT " << path << std::endl << source.FragmentSource << std::endl;
+        program = CreateShader(source.VertexSource, source.FragmentSource);
+    }
+    ProgramCache::Store(key, program);
+    return program;
+}
+
+// compiling and linking requested, no status asked for, so the driver may do it in the background
+static unsigned int SubmitProgram(const ShaderProgramSource &source)
+{
+    GLCall( unsigned int program = glCreateProgram() );
+    std::vector<std::pair<unsigned int, const std::string *>> stages;
+    if (!source.ComputeSource.empty())
+        stages = { { GL_COMPUTE_SHADER, &source.ComputeSource } };
+    else
+        stages = { { GL_VERTEX_SHADER, &source.VertexSource }, { GL_FRAGMENT_SHADER, &source.FragmentSource } };
+    for (auto &stage : stages)
+    {
+        GLCall( unsigned int id = glCreateShader(stage.first) );
+        const char *src = stage.second->c_str();
+        GLCall( glShaderSource(id, 1, &src, nullptr) );
+        GLCall( glCompileShader(id) );
+        GLCall( glAttachShader(program, id) );
+        // freed with the program, the compile log stays readable until then
+        GLCall( glDeleteShader(id) );
+    }
+    ProgramCache::PrepareLink(program);
+    GLCall( glLinkProgram(program) );
+    return program;
+}
+
+// the link status, waits for the driver if it is still compiling; 0 and the logs when it failed
+static unsigned int FinishProgram(unsigned int program, const std::string &path)
+{
+    GLint linked = GL_FALSE;
+    GLCall( glGetProgramiv(program, GL_LINK_STATUS, &linked) );
+    std::cout << "Program " << path << " link status: " << linked << std::endl;
+    if (linked == GL_TRUE)
+        return program;
+
+    GLchar message[1024];
+    GLsizei count = 0;
+    GLuint stages[3];
+    GLCall( glGetAttachedShaders(program, 3, &count, stages) );
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        GLint compiled = GL_FALSE, type = 0;
+        GLCall( glGetShaderiv(stages[i], GL_COMPILE_STATUS, &compiled) );
+        GLCall( glGetShaderiv(stages[i], GL_SHADER_TYPE, &type) );
+        if (compiled == GL_TRUE)
+            continue;
+        GLCall( glGetShaderInfoLog(stages[i], sizeof(message), nullptr, message) );
+        std::cout << "Failed to compile " << ShaderTypeName(unsigned(type)) << " shader of " << path << std::endl << message << std::endl;
+    }
+    GLCall( glGetProgramInfoLog(program, sizeof(message), nullptr, message) );
+    std::cout << "Failed to link program " << path << std::endl << message << std::endl;
+    GLCall( glDeleteProgram(program) );
+    return 0;
+}
+
+Shader::Shader(const std::string &path, const std::vector<std::string> &defines, ShaderBatch *batch)
+        : Shader(path, Parse(path), defines, batch) {}
+
+Shader::Shader(const std::string &path, const ShaderProgramSource &source, const std::vector<std::string> &defines,
+               ShaderBatch *batch)
+        : mPath(path), source(source), mDefines(defines) {
+    if (batch == nullptr) {
+        this->mID = BuildProgram(this->source, this->mDefines, path);
+        this->mOwned = this->mID != 0;
+        this->Reflect();
+        return;
+    }
+    ShaderProgramSource defined = Defined(this->source, this->mDefines);
+    this->mPendingKey = CacheKey(defined);
+    this->mID = ProgramCache::Load(this->mPendingKey);
+    if (this->mID != 0) {
+        std::cout << "Program " << path << " from cache" << std::endl;
+        this->mOwned = true;
+        this->Reflect();
+        return;
+    }
+    this->mPending = SubmitProgram(defined);
+    // drawn with the fallback until Complete swaps the real one in
+    this->mID = batch->getFallback().mID;
+    this->mUniforms = batch->getFallback().mUniforms;
+    batch->Add(*this);
 }
 
 Shader::~Shader() {
+    if (this->mPending != 0) {
+        GLCall( glDeleteProgram(this->mPending) );
+    }
+    if (this->mOwned) {
+        GLCall( glDeleteProgram(this->mID) );
+    }
+}
+
+bool Shader::Complete(bool wait) {
+    if (this->mPending == 0)
+        return false;
+    if (!wait && GLAD_GL_KHR_parallel_shader_compile) {
+        GLint done = GL_FALSE;
+        GLCall( glGetProgramiv(this->mPending, GL_COMPLETION_STATUS_KHR, &done) );
+        if (done != GL_TRUE)
+            return false;
+    }
+    unsigned int program = FinishProgram(this->mPending, this->mPath);
+    this->mPending = 0;
+    // a program that failed leaves the fallback in place
+    if (program == 0)
+        return false;
+    ProgramCache::Store(this->mPendingKey, program);
+    this->mID = program;
+    this->mOwned = true;
+    this->Reflect();
+    return true;
+}
+
+bool Shader::Reload(const ShaderProgramSource &source) {
+    unsigned int program = BuildProgram(source, this->mDefines, this->mPath);
+    if (program == 0)
+        return false;
+    // still compiling the old sources, or they failed to link: mID is the fallback's, which stays
+    if (this->mPending != 0) {
+        GLCall( glDeleteProgram(this->mPending) );
+        this->mPending = 0;
+    }
+    if (this->mOwned) {
+        GLCall( glDeleteProgram(this->mID) );
+    }
+    this->mID = program;
+    this->mOwned = true;
+    this->source = source;
+    this->Reflect();
+    return true;
+}
+
+struct BlockBinding
+{
+    unsigned int binding;
+    size_t size;
+};
+
+static std::unordered_map<std::string, BlockBinding> blockBindings;
 
+void Shader::setBlockBinding(const std::string &block, unsigned int binding, size_t size) {
+    blockBindings[block] = { binding, size };
+}
+
+void Shader::Reflect() {
+    this->mUniforms.clear();
+    if (this->mID == 0)
+        return;
+
+    // bindings are program state, lost with every link
+    GLint blocks = 0;
+    GLchar block[256];
+    GLCall( glGetProgramiv(this->mID, GL_ACTIVE_UNIFORM_BLOCKS, &blocks) );
+    for (GLint i = 0; i < blocks; ++i)
+    {
+        GLCall( glGetActiveUniformBlockName(this->mID, GLuint(i), sizeof(block), nullptr, block) );
+        auto it = blockBindings.find(block);
+        if (it == blockBindings.end())
+            continue;
+        GLint size = 0;
+        GLCall( glGetActiveUniformBlockiv(this->mID, GLuint(i), GL_UNIFORM_BLOCK_DATA_SIZE, &size) );
+        if (size_t(size) > it->second.size)
+            std::cout << "Failed to match uniform block " << block << " of " << this->mPath << ": " << size
+                      << " bytes, the buffer has " << it->second.size << std::endl;
+        GLCall( glUniformBlockBinding(this->mID, GLuint(i), it->second.binding) );
+    }
+
+    GLint count = 0, maxLength = 0;
+    GLCall( glGetProgramiv(this->mID, GL_ACTIVE_UNIFORMS, &count) );
+    GLCall( glGetProgramiv(this->mID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength) );
+    std::vector<GLchar> name(size_t(std::max(maxLength, 1)));
+    for (GLint i = 0; i < count; ++i)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        GLCall( glGetActiveUniform(this->mID, GLuint(i), GLsizei(name.size()), &length, &size, &type, name.data()) );
+        std::string uniform(name.data(), size_t(length));
+        // the index is not the location; members of uniform blocks have none
+        GLCall( GLint location = glGetUniformLocation(this->mID, uniform.c_str()) );
+        if (location < 0)
+            continue;
+        this->mUniforms[UniformHash(uniform.c_str())] = location;
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+            this->mUniforms[UniformHash(uniform.substr(0, uniform.size() - 3).c_str())] = location;
+    }
+}
+
+UniformId Shader::Uniform(uint32_t id) const {
+    UniformId result;
+    auto it = this->mUniforms.find(id);
+    if (it != this->mUniforms.end())
+        result.location = it->second;
+    return result;
 }
 
 void Shader::setMat4f(const std::string &name, float *data) {
-    GLCall(glUniformMatrix4fv( glGetUniformLocation(this->mID, name.c_str()), 1, GL_FALSE, data ); );
+    this->setMat4f(this->Uniform(name), data);
 }
 
 void Shader::setVec3f(const std::string &name, float *data) {
-    GLCall(glUniform3fv( glGetUniformLocation(this->mID, name.c_str()), 1, data ); );
+    this->setVec3f(this->Uniform(name), data);
+}
+
+void Shader::setFloat(const std::string &name, float value) {
+    this->setFloat(this->Uniform(name), value);
+}
+
+void Shader::setInt(const std::string &name, int value) {
+    this->setInt(this->Uniform(name), value);
+}
+
+void Shader::Dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+    GLCall( glDispatchCompute(groupsX, groupsY, groupsZ) );
 }
@@ -5,28 +5,99 @@
 #ifndef PROJECT_SHADER_H
 #define PROJECT_SHADER_H
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "ErrorChecker.h"
+#include "UniformHash.h"
+
+// guards against files including each other
+#define SHADER_INCLUDE_DEPTH 16
 
 struct ShaderProgramSource
 {
     std::string VertexSource;
     std::string FragmentSource;
+    std::string ComputeSource;
+    std::vector<std::string> Files;     // the .shader file and everything it includes
+};
+
+// uniform location resolved once by Shader::Uniform; -1 for a name the program does not use,
+// setting it is a no-op as in glUniform*
+struct UniformId
+{
+    int location = -1;
 };
 
+class ShaderBatch;
+
 class Shader {
 private:
     unsigned int mID;
+    std::string mPath;
     struct ShaderProgramSource source;
+    std::vector<std::string> mDefines;
+    // program the driver is still compiling, mID is the fallback's meanwhile
+    unsigned int mPending = 0;
+    uint64_t mPendingKey = 0;
+    // false while mID is the batch's fallback, which the shader must not delete
+    bool mOwned = false;
+    // active uniforms by UniformHash of the name after linking, arrays under both "name" and "name[0]"
+    std::unordered_map<uint32_t, int> mUniforms;
+
+    void Reflect();
 public:
-    Shader(const std::string &path);
+    // defines as "NAME" or "NAME=value", inserted after #version of every stage. with a batch the program
+    // is only submitted and the shader draws with the batch's fallback until it is linked
+    explicit Shader(const std::string &path, const std::vector<std::string> &defines = {}, ShaderBatch *batch = nullptr);
+    Shader(const std::string &path, const ShaderProgramSource &source, const std::vector<std::string> &defines,
+           ShaderBatch *batch = nullptr);
+    // deletes the programs it built, never the batch's fallback
     ~Shader();
+    Shader(const Shader &) = delete;
+    Shader &operator=(const Shader &) = delete;
     inline const void Use() { GLCall( glUseProgram(this->mID); ); }
     inline const void NotUse() { GLCall( glUseProgram(0); ); }
     inline const unsigned int getID() { return this->mID; }
+    inline const std::string &getPath() const { return this->mPath; }
+
+    inline const std::vector<std::string> &getDefines() const { return this->mDefines; }
+    inline bool IsPending() const { return this->mPending != 0; }
 
+    // swaps the submitted program in once the driver is done, without wait only if that does not block
+    // (KHR_parallel_shader_compile). true when it was swapped in: UniformIds have to be resolved again
+    bool Complete(bool wait);
+
+    // resolves #include "file" and splits a .shader file at its #shader lines, no GL involved
+    static struct ShaderProgramSource Parse(const std::string &path);
+    // builds a program from new sources with the same defines and swaps it in; on failure the old program stays.
+    // uniform locations may move, UniformIds have to be resolved again
+    bool Reload(const ShaderProgramSource &source);
+
+    // one map lookup, no driver call; resolve before the frame loop. by id the name is hashed at compile
+    // time, as in the structs of the generated ShaderUniforms.h
+    UniformId Uniform(uint32_t id) const;
+    inline UniformId Uniform(const std::string &name) const { return this->Uniform(UniformHash(name.c_str())); }
+    inline size_t getUniformCount() const { return this->mUniforms.size(); }
+
+    inline void setMat4f(UniformId id, const float *data) { GLCall( glUniformMatrix4fv(id.location, 1, GL_FALSE, data) ); }
+    inline void setVec3f(UniformId id, const float *data) { GLCall( glUniform3fv(id.location, 1, data) ); }
+    inline void setFloat(UniformId id, float value) { GLCall( glUniform1f(id.location, value) ); }
+    inline void setInt(UniformId id, int value) { GLCall( glUniform1i(id.location, value) ); }
+
+    // by name, looked up in the reflected uniforms on every call
     void setMat4f(const std::string &name, float *data);
     void setVec3f(const std::string &name, float *data);
+    void setFloat(const std::string &name, float value);
+    void setInt(const std::string &name, int value);
+
+    // every program linked from now on gets the uniform block of that name at the buffer binding; a block
+    // the driver lays out larger than size (sizeof the struct filling it) is reported
+    static void setBlockBinding(const std::string &block, unsigned int binding, size_t size);
+
+    // compute programs only, the program has to be in use
+    void Dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1);
 };
 
 
@@ -0,0 +1,66 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include <glad/glad.h>
+#include "ShaderBatch.h"
+#include "ErrorChecker.h"
+
+#include <algorithm>
+#include <iostream>
+
+ShaderBatch::ShaderBatch(const std::string &fallbackPath)
+        : mFallback(fallbackPath), mStart(std::chrono::steady_clock::now()),
+          mParallel(GLAD_GL_KHR_parallel_shader_compile != 0) {
+    // let the driver use as many threads as it likes
+    if (this->mParallel) {
+        GLCall( glMaxShaderCompilerThreadsKHR(0xFFFFFFFF) );
+    }
+}
+
+void ShaderBatch::Add(Shader &shader) {
+    if (shader.IsPending())
+        this->mPending.push_back(&shader);
+}
+
+bool ShaderBatch::Complete(Shader &shader, bool wait) {
+    bool swapped = shader.Complete(wait);
+    if (!shader.IsPending())
+        this->mPending.erase(std::find(this->mPending.begin(), this->mPending.end(), &shader));
+    if (this->mPending.empty())
+        std::cout << "Programs linked "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->mStart).count()
+                  << " ms after submission" << (this->mParallel ? ", in parallel" : "") << std::endl;
+    return swapped;
+}
+
+bool ShaderBatch::Poll() {
+    bool swapped = false;
+    // copied, Complete removes from mPending
+    std::vector<Shader *> pending = this->mPending;
+    for (Shader *shader : pending)
+    {
+        // a shader reloaded meanwhile was built synchronously
+        if (!shader->IsPending()) {
+            this->mPending.erase(std::find(this->mPending.begin(), this->mPending.end(), shader));
+            continue;
+        }
+        swapped = this->Complete(*shader, false) || swapped;
+        if (!this->mParallel)
+            break;
+    }
+    return swapped;
+}
+
+bool ShaderBatch::Finish() {
+    bool swapped = false;
+    while (!this->mPending.empty())
+    {
+        Shader *shader = this->mPending.front();
+        if (!shader->IsPending())
+            this->mPending.erase(this->mPending.begin());
+        else
+            swapped = this->Complete(*shader, true) || swapped;
+    }
+    return swapped;
+}
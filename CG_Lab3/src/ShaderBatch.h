@@ -0,0 +1,44 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_SHADERBATCH_H
+#define PROJECT_SHADERBATCH_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Shader.h"
+
+
+// shaders whose programs are all submitted up front and picked up once linked, so the driver compiles
+// them while the CPU loads assets and draws frames. until then each draws with one small fallback program.
+// with KHR_parallel_shader_compile the driver compiles on its own threads and Poll never blocks; without it
+// the link status query blocks, so Poll completes one program per call to spread the stall over frames
+class ShaderBatch {
+private:
+    Shader mFallback;
+    std::vector<Shader *> mPending;
+    std::chrono::steady_clock::time_point mStart;
+    bool mParallel;
+
+    // true when the program was swapped in
+    bool Complete(Shader &shader, bool wait);
+public:
+    // compiles the fallback right away
+    explicit ShaderBatch(const std::string &fallbackPath);
+
+    inline const Shader &getFallback() const { return this->mFallback; }
+    inline bool IsDone() const { return this->mPending.empty(); }
+    inline bool IsParallel() const { return this->mParallel; }
+
+    // called by a Shader constructed with this batch; the shader has to outlive the batch's use of it
+    void Add(Shader &shader);
+    // swaps in what is linked by now; true when any program was swapped in, their UniformIds need resolving
+    bool Poll();
+    // waits for every program
+    bool Finish();
+};
+
+
+#endif //PROJECT_SHADERBATCH_H
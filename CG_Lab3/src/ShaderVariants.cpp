@@ -0,0 +1,37 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "ShaderVariants.h"
+
+#include <algorithm>
+#include <iostream>
+
+ShaderVariants::ShaderVariants(const std::string &path) : mPath(path), mSource(Shader::Parse(path)) {}
+
+std::string ShaderVariants::Key(std::vector<std::string> defines) {
+    std::sort(defines.begin(), defines.end());
+    std::string key;
+    for (const std::string &define : defines)
+        key += (key.empty() ? "" : " ") + define;
+    return key;
+}
+
+Shader &ShaderVariants::Get(const std::vector<std::string> &defines, ShaderBatch *batch) {
+    std::string key = Key(defines);
+    auto it = this->mVariants.find(key);
+    if (it != this->mVariants.end())
+        return *it->second;
+    std::cout << "Variant [" << key << "] of " << this->mPath << std::endl;
+    std::unique_ptr<Shader> &variant = this->mVariants[key];
+    variant.reset(new Shader(this->mPath, this->mSource, defines, batch));
+    return *variant;
+}
+
+bool ShaderVariants::Reload(const ShaderProgramSource &source) {
+    this->mSource = source;
+    bool ok = true;
+    for (auto &variant : this->mVariants)
+        ok = variant.second->Reload(source) && ok;
+    return ok;
+}
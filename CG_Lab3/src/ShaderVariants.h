@@ -0,0 +1,40 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_SHADERVARIANTS_H
+#define PROJECT_SHADERVARIANTS_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+
+
+// one .shader file compiled once per set of feature defines (e.g. SPECULAR, EMISSIVE, TEXTURES=2),
+// each variant on its first use. a draw that lacks a feature uses the variant without it
+// instead of branching on a uniform
+class ShaderVariants {
+private:
+    std::string mPath;
+    ShaderProgramSource mSource;
+    std::unordered_map<std::string, std::unique_ptr<Shader>> mVariants;
+public:
+    // reads and preprocesses the file, nothing is compiled yet
+    explicit ShaderVariants(const std::string &path);
+
+    inline const std::string &getPath() const { return this->mPath; }
+    inline size_t Size() const { return this->mVariants.size(); }
+
+    // sorted and joined, the same defines in any order are one variant
+    static std::string Key(std::vector<std::string> defines);
+    // compiled on the first call for these defines, or submitted to the batch; the reference stays valid,
+    // also across reloads
+    Shader &Get(const std::vector<std::string> &defines, ShaderBatch *batch = nullptr);
+    // rebuilds every compiled variant from new sources; false if any kept its old program
+    bool Reload(const ShaderProgramSource &source);
+};
+
+
+#endif //PROJECT_SHADERVARIANTS_H
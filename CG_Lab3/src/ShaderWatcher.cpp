@@ -0,0 +1,129 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "ShaderWatcher.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// how often the worker looks at mStop while nothing happens
+#define WATCHER_POLL_MS 100
+
+static bool IsShaderFile(const std::string &name)
+{
+    static const std::string extension = ".shader";
+    return name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+ShaderWatcher::ShaderWatcher() : mStop(false), mPending(false) {}
+
+ShaderWatcher::~ShaderWatcher() {
+    this->Stop();
+}
+
+bool ShaderWatcher::Start(const std::string &directory) {
+    this->mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // editors either rewrite the file or rename a new one over it
+    if (this->mNotify < 0 || inotify_add_watch(this->mNotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cout << "Failed to watch " << directory << " for shader changes" << std::endl;
+        this->Stop();
+        return false;
+    }
+    this->mDirectory = directory;
+    this->mStop = false;
+    this->mThread = std::thread(&ShaderWatcher::WorkerLoop, this);
+    std::cout << "Watching " << directory << " for shader changes" << std::endl;
+    return true;
+}
+
+void ShaderWatcher::Stop() {
+    this->mStop = true;
+    if (this->mThread.joinable())
+        this->mThread.join();
+    if (this->mNotify >= 0)
+        close(this->mNotify);
+    this->mNotify = -1;
+}
+
+void ShaderWatcher::WorkerLoop() {
+    // who includes what, from the files as they are now
+    if (DIR *directory = opendir(this->mDirectory.c_str())) {
+        while (dirent *entry = readdir(directory))
+        {
+            if (!IsShaderFile(entry->d_name))
+                continue;
+            std::string path = this->mDirectory + "/" + entry->d_name;
+            std::vector<std::string> files = Shader::Parse(path).Files;
+            for (size_t i = 1; i < files.size(); ++i)
+                this->mIncludedBy[files[i]].push_back(path);
+        }
+        closedir(directory);
+    }
+
+    alignas(struct inotify_event) char buffer[4096];
+    while (!this->mStop)
+    {
+        pollfd descriptor = { this->mNotify, POLLIN, 0 };
+        if (poll(&descriptor, 1, WATCHER_POLL_MS) <= 0)
+            continue;
+        ssize_t size = read(this->mNotify, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < size; )
+        {
+            auto *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+            offset += ssize_t(sizeof(struct inotify_event) + event->len);
+            if (event->len == 0)
+                continue;
+            auto saved = std::chrono::steady_clock::now();
+            std::string path = this->mDirectory + "/" + event->name;
+            if (IsShaderFile(event->name)) {
+                this->Changed(path, saved);
+            } else {
+                auto it = this->mIncludedBy.find(path);
+                if (it == this->mIncludedBy.end())
+                    continue;
+                std::vector<std::string> dependents = it->second;
+                for (const std::string &dependent : dependents)
+                    this->Changed(dependent, saved);
+            }
+        }
+    }
+}
+
+void ShaderWatcher::Changed(const std::string &path, std::chrono::steady_clock::time_point saved) {
+    ShaderChange change;
+    change.saved = saved;
+    change.path = path;
+    change.source = Shader::Parse(path);
+
+    // the includes may have changed with the file
+    for (auto &entry : this->mIncludedBy)
+        entry.second.erase(std::remove(entry.second.begin(), entry.second.end(), path), entry.second.end());
+    for (size_t i = 1; i < change.source.Files.size(); ++i)
+        this->mIncludedBy[change.source.Files[i]].push_back(path);
+
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    bool replaced = false;
+    for (ShaderChange &pending : this->mChanges)
+        if (pending.path == change.path) {
+            pending = change;
+            replaced = true;
+        }
+    if (!replaced)
+        this->mChanges.push_back(change);
+    this->mPending = true;
+}
+
+std::vector<ShaderChange> ShaderWatcher::Poll() {
+    std::vector<ShaderChange> changes;
+    if (!this->mPending)
+        return changes;
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    changes.swap(this->mChanges);
+    this->mPending = false;
+    return changes;
+}
@@ -0,0 +1,57 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_SHADERWATCHER_H
+#define PROJECT_SHADERWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+
+// a .shader file saved since the last Poll, or one including a saved file, already read and split
+struct ShaderChange
+{
+    std::string path;               // directory + "/" + file name, as passed to Shader
+    ShaderProgramSource source;
+    std::chrono::steady_clock::time_point saved;
+};
+
+
+// watches a directory with inotify on its own thread and parses changed .shader files there,
+// so the render thread only compiles and links. a saved include counts as a change of every
+// .shader file including it. one pending change per file, the newest wins
+class ShaderWatcher {
+private:
+    std::string mDirectory;
+    int mNotify = -1;
+    std::thread mThread;
+    std::atomic<bool> mStop;
+    std::atomic<bool> mPending;
+    std::mutex mMutex;
+    std::vector<ShaderChange> mChanges;
+    // worker side: included file -> .shader files including it
+    std::unordered_map<std::string, std::vector<std::string>> mIncludedBy;
+
+    void WorkerLoop();
+    // parses, updates mIncludedBy and queues the change
+    void Changed(const std::string &path, std::chrono::steady_clock::time_point saved);
+public:
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    bool Start(const std::string &directory);
+    void Stop();
+    inline bool IsRunning() const { return this->mNotify >= 0; }
+
+    // changes since the last call; one atomic load when there are none
+    std::vector<ShaderChange> Poll();
+};
+
+
+#endif //PROJECT_SHADERWATCHER_H
@@ -0,0 +1,21 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_SIMD_H
+#define PROJECT_SIMD_H
+
+// vector paths are compiled with __attribute__((target("avx2,fma"))) and chosen at run time
+
+// true if the CPU executing us has AVX2 and FMA
+inline bool CpuHasAVX2()
+{
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }();
+    return supported;
+}
+
+
+#endif //PROJECT_SIMD_H
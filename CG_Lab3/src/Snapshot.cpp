@@ -0,0 +1,139 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "Snapshot.h"
+
+#include <cstring>
+#include <iostream>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::vector<float> Bodies::*const ARRAYS[SNAPSHOT_ARRAYS] = {
+        &Bodies::x, &Bodies::y, &Bodies::z,
+        &Bodies::vx, &Bodies::vy, &Bodies::vz,
+        &Bodies::ax, &Bodies::ay, &Bodies::az,
+        &Bodies::mass, &Bodies::radius
+};
+
+// the whole buffer at offset, retried on short writes
+static bool WriteAll(int fd, const void *data, size_t size, uint64_t offset)
+{
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        ssize_t written = pwrite(fd, bytes, size, off_t(offset));
+        if (written <= 0)
+            return false;
+        bytes += written;
+        size -= size_t(written);
+        offset += uint64_t(written);
+    }
+    return true;
+}
+
+Snapshot::Snapshot() {
+
+}
+
+Snapshot::~Snapshot() {
+    this->Close();
+}
+
+bool Snapshot::Open(const std::string &path) {
+    this->Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Failed to open snapshot " << path << std::endl;
+        return false;
+    }
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(SnapshotHeader)) {
+        std::cout << "Snapshot " << path << " is too short" << std::endl;
+        close(fd);
+        return false;
+    }
+    size_t size = size_t(info.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cout << "Failed to map snapshot " << path << std::endl;
+        return false;
+    }
+
+    const auto *header = static_cast<const SnapshotHeader *>(mapping);
+    bool valid = std::memcmp(header->magic, SNAPSHOT_MAGIC, 4) == 0 && header->version == SNAPSHOT_VERSION
+            && header->bodyCount <= size / sizeof(float);
+    for (size_t i = 0; valid && i < SNAPSHOT_ARRAYS; ++i)
+        valid = header->arrayOffset[i] % SNAPSHOT_ALIGNMENT == 0 && header->arrayOffset[i] >= sizeof(SnapshotHeader)
+                && header->arrayOffset[i] + header->bodyCount * sizeof(float) <= size;
+    if (!valid) {
+        std::cout << "Snapshot " << path << " has a wrong header" << std::endl;
+        munmap(mapping, size);
+        return false;
+    }
+
+    this->mMapping = mapping;
+    this->mMappingSize = size;
+    this->mHeader = header;
+    // a restore reads everything at once, start reading the pages in now
+    madvise(mapping, size, MADV_WILLNEED);
+    return true;
+}
+
+void Snapshot::Close() {
+    if (this->mMapping != nullptr)
+        munmap(this->mMapping, this->mMappingSize);
+    this->mMapping = nullptr;
+    this->mMappingSize = 0;
+    this->mHeader = nullptr;
+}
+
+void Snapshot::Restore(Bodies &bodies) const {
+    size_t n = this->getBodyCount();
+    for (size_t i = 0; i < SNAPSHOT_ARRAYS; ++i)
+    {
+        const float *array = this->Array(i);
+        (bodies.*ARRAYS[i]).assign(array, array + n);
+    }
+}
+
+bool Snapshot::Save(const std::string &path, const Bodies &bodies, const SnapshotClock &clock,
+                    const SnapshotCamera &camera)
+{
+    size_t n = bodies.Size();
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, 4);
+    header.version = SNAPSHOT_VERSION;
+    header.bodyCount = n;
+    header.clock = clock;
+    header.camera = camera;
+    uint64_t offset = sizeof(SnapshotHeader);
+    for (uint64_t &arrayOffset : header.arrayOffset)
+    {
+        arrayOffset = (offset + SNAPSHOT_ALIGNMENT - 1) & ~uint64_t(SNAPSHOT_ALIGNMENT - 1);
+        offset = arrayOffset + n * sizeof(float);
+    }
+
+    std::string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cout << "Failed to write snapshot " << path << std::endl;
+        return false;
+    }
+    // the gaps before the aligned arrays are never written and read back as zeros
+    bool ok = ftruncate(fd, off_t(offset)) == 0 && WriteAll(fd, &header, sizeof(header), 0);
+    for (size_t i = 0; ok && i < SNAPSHOT_ARRAYS; ++i)
+        ok = WriteAll(fd, (bodies.*ARRAYS[i]).data(), n * sizeof(float), header.arrayOffset[i]);
+    ok = close(fd) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cout << "Failed to write snapshot " << path << std::endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
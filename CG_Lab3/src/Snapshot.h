@@ -0,0 +1,88 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_SNAPSHOT_H
+#define PROJECT_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include "Bodies.h"
+
+#define SNAPSHOT_MAGIC "SNAP"
+#define SNAPSHOT_VERSION 1
+// arrays of Bodies in file order: x y z vx vy vz ax ay az mass radius
+#define SNAPSHOT_ARRAYS 11
+// every array starts on a cache line
+#define SNAPSHOT_ALIGNMENT 64
+
+// simulation clock and mode
+struct SnapshotClock
+{
+    double simTime;
+    float timeWarp;
+    uint32_t analytic;
+    uint32_t integrator;
+    uint32_t reserved;
+};
+
+struct SnapshotCamera
+{
+    float position[3];
+    float front[3];
+    float up[3];
+    float pitch, yaw;
+    float theta, phi;               // orbit camera angles
+    float fov;
+    uint32_t perspective;
+    uint32_t move;
+};
+
+// file layout, little endian:
+//   header
+//   float array[SNAPSHOT_ARRAYS][bodyCount]   each at arrayOffset[i], SNAPSHOT_ALIGNMENT aligned
+struct SnapshotHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t bodyCount;
+    uint64_t arrayOffset[SNAPSHOT_ARRAYS];
+    SnapshotClock clock;
+    SnapshotCamera camera;
+};
+
+
+// whole simulation state in one file: written with one write per array, read back from a mapping
+class Snapshot {
+private:
+    void *mMapping = nullptr;
+    size_t mMappingSize = 0;
+    const SnapshotHeader *mHeader = nullptr;
+public:
+    Snapshot();
+    ~Snapshot();
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+
+    // maps the file and checks the header, the arrays are not touched
+    bool Open(const std::string &path);
+    void Close();
+
+    inline bool IsOpen() const { return this->mHeader != nullptr; }
+    inline size_t getBodyCount() const { return this->mHeader ? size_t(this->mHeader->bodyCount) : 0; }
+    inline const SnapshotClock &getClock() const { return this->mHeader->clock; }
+    inline const SnapshotCamera &getCamera() const { return this->mHeader->camera; }
+    // array i of the file order, straight from the mapping
+    inline const float *Array(size_t i) const {
+        return reinterpret_cast<const float *>(static_cast<const char *>(this->mMapping) + this->mHeader->arrayOffset[i]);
+    }
+    // copies every array into bodies, one block copy each
+    void Restore(Bodies &bodies) const;
+
+    // writes to a temporary file and renames it over path, so a crash never leaves half a snapshot
+    static bool Save(const std::string &path, const Bodies &bodies, const SnapshotClock &clock,
+                     const SnapshotCamera &camera);
+};
+
+
+#endif //PROJECT_SNAPSHOT_H
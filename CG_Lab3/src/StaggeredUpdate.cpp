@@ -0,0 +1,127 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "StaggeredUpdate.h"
+#include "Clock.h"
+
+#include <chrono>
+#include <cmath>
+
+// items between two looks at the clock while interpolating
+#define STAGGER_CLOCK_STRIDE 256
+
+StaggeredUpdate::StaggeredUpdate(int levels, float nearDistance)
+        : mLevels(std::max(1, std::min(levels, 8))), mNear(nearDistance),
+          mSlots((size_t(1) << this->mLevels) - 1) {}
+
+int StaggeredUpdate::Level(float distance) const {
+    if (distance < this->mNear)
+        return 0;
+    return std::min(1 + int(std::log2(distance / this->mNear)) + this->mBias, this->mLevels - 1);
+}
+
+void StaggeredUpdate::Resize(size_t count) {
+    size_t old = this->mKeys.size();
+    if (count < old) {
+        auto gone = [count](uint32_t item) { return item >= count; };
+        for (std::vector<uint32_t> &slot : this->mSlots)
+            slot.erase(std::remove_if(slot.begin(), slot.end(), gone), slot.end());
+        this->mCarry.erase(std::remove_if(this->mCarry.begin(), this->mCarry.end(), gone), this->mCarry.end());
+    }
+    this->mKeys.resize(count);
+    this->mLevel.resize(count, 0);
+    this->mKeyed.resize(count, 0);
+    this->mQueued.resize(count, 0);
+    // level 0 has one slot, visited on every frame
+    for (size_t i = old; i < count; ++i)
+        this->mSlots[0].push_back(uint32_t(i));
+}
+
+void StaggeredUpdate::Invalidate() {
+    std::fill(this->mKeyed.begin(), this->mKeyed.end(), 0);
+    for (size_t i = 0; i < this->mKeys.size(); ++i)
+        if (!this->mQueued[i]) {
+            this->mQueued[i] = 1;
+            this->mCarry.push_back(uint32_t(i));
+        }
+}
+
+const std::vector<uint32_t> &StaggeredUpdate::Due(uint64_t frame, const std::function<float(uint32_t)> &distance) {
+    this->mDue.swap(this->mCarry);
+    this->mCarry.clear();
+    this->mMoved.clear();
+    for (int level = 0; level < this->mLevels; ++level)
+    {
+        std::vector<uint32_t> &slot = this->mSlots[Slot(level, frame)];
+        size_t kept = 0;
+        for (uint32_t item : slot)
+        {
+            int now = this->Level(distance(item));
+            // moved after the walk, the slot of a slower level may still come in this frame
+            if (now != level) {
+                this->mLevel[item] = uint8_t(now);
+                this->mMoved.push_back(item);
+            } else {
+                slot[kept++] = item;
+            }
+            if (!this->mQueued[item]) {
+                this->mQueued[item] = 1;
+                this->mDue.push_back(item);
+            }
+        }
+        slot.resize(kept);
+    }
+    // in the slot of this frame's phase, due again in exactly 2^level frames
+    for (uint32_t item : this->mMoved)
+        this->mSlots[Slot(this->mLevel[item], frame)].push_back(item);
+    return this->mDue;
+}
+
+void StaggeredUpdate::Carry(size_t done) {
+    done = std::min(done, this->mDue.size());
+    for (size_t k = 0; k < done; ++k)
+        this->mQueued[this->mDue[k]] = 0;
+    this->mCarry.assign(this->mDue.begin() + done, this->mDue.end());
+}
+
+void StaggeredUpdate::SetKey(uint32_t item, double time, const glm::vec3 &target, double targetTime) {
+    Key &key = this->mKeys[item];
+    key.from = this->mKeyed[item] ? this->At(item, time) : target;
+    key.fromTime = time;
+    key.to = target;
+    key.toTime = targetTime;
+    this->mKeyed[item] = 1;
+}
+
+glm::vec3 StaggeredUpdate::At(uint32_t item, double time) const {
+    const Key &key = this->mKeys[item];
+    if (key.toTime <= key.fromTime || time >= key.toTime)
+        return key.to;
+    float t = float((time - key.fromTime) / (key.toTime - key.fromTime));
+    return glm::mix(key.from, key.to, std::max(t, 0.0f));
+}
+
+size_t StaggeredUpdate::Interpolate(double time, double maxMs, size_t maxItems,
+                                    const std::function<void(uint32_t, const glm::vec3 &)> &write) const {
+    auto start = std::chrono::steady_clock::now();
+    size_t written = 0;
+    for (size_t s = 1; s < this->mSlots.size(); ++s)
+        for (uint32_t item : this->mSlots[s])
+        {
+            if (written == maxItems)
+                return written;
+            if (++written % STAGGER_CLOCK_STRIDE == 0 && Milliseconds(start) > maxMs)
+                return written;
+            if (this->mKeyed[item])
+                write(item, this->At(item, time));
+        }
+    return written;
+}
+
+void StaggeredUpdate::Adapt(double cost, double budget) {
+    if ((cost > budget || !this->mCarry.empty()) && this->mBias < this->mLevels - 1)
+        ++this->mBias;
+    else if (cost < 0.5 * budget && this->mCarry.empty() && this->mBias > 0)
+        --this->mBias;
+}
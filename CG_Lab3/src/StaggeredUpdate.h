@@ -0,0 +1,77 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_STAGGEREDUPDATE_H
+#define PROJECT_STAGGEREDUPDATE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+
+// items recomputed less often the farther they are: level l runs every 2^l frames. each level keeps its
+// items in 2^l slots and a frame only visits the slot of its phase in every level, so the per-frame cost
+// follows the due items, not the item count. between two runs positions are interpolated
+class StaggeredUpdate {
+private:
+    struct Key
+    {
+        glm::vec3 from, to;
+        double fromTime, toTime;
+    };
+
+    int mLevels;
+    float mNear;
+    int mBias = 0;                    // extra levels for everything beyond the near distance
+    std::vector<Key> mKeys;
+    std::vector<uint8_t> mLevel;
+    std::vector<char> mKeyed;
+    std::vector<char> mQueued;        // in the due list or carried
+    // slot s of level l at index 2^l - 1 + s, its items are due on the frames with frame % 2^l == s
+    std::vector<std::vector<uint32_t>> mSlots;
+    std::vector<uint32_t> mDue;
+    std::vector<uint32_t> mCarry;     // due but not reached within the budget, first on the next frame
+    std::vector<uint32_t> mMoved;
+
+    static inline size_t Slot(int level, uint64_t frame) {
+        return (size_t(1) << level) - 1 + size_t(frame & ((uint64_t(1) << level) - 1));
+    }
+    int Level(float distance) const;
+public:
+    // items closer than nearDistance run every frame, each doubling of the distance halves the rate
+    StaggeredUpdate(int levels, float nearDistance);
+
+    // new items are due on the next frame
+    void Resize(size_t count);
+    inline size_t Size() const { return this->mKeys.size(); }
+    // forgets every key, e.g. after the time jumped; all items are carried into the next frames
+    void Invalidate();
+
+    // items to recompute on this frame: the carried ones, then the slot of this frame in every level.
+    // distance(i) from the viewer is asked only for the items of those slots, which move to their new level
+    const std::vector<uint32_t> &Due(uint64_t frame, const std::function<float(uint32_t)> &distance);
+    // the first done items of the due list were recomputed, the rest go first on the next frame
+    void Carry(size_t done);
+    inline size_t getCarried() const { return this->mCarry.size(); }
+    // frames until a due item runs again, its key should be computed that many frames minus one ahead
+    inline int Frames(uint32_t item) const { return this->mKeyed[item] ? 1 << this->mLevel[item] : 1; }
+    // exact state of a due item at time target, the interpolation continues from where it is at time
+    void SetKey(uint32_t item, double time, const glm::vec3 &target, double targetTime);
+    glm::vec3 At(uint32_t item, double time) const;
+    // writes the interpolated positions level by level from the nearest, until maxMs are spent or maxItems
+    // are visited; level 0 is keyed on every frame and left out. returns the number of items visited
+    size_t Interpolate(double time, double maxMs, size_t maxItems,
+                       const std::function<void(uint32_t, const glm::vec3 &)> &write) const;
+
+    // moves the far items to slower levels while the last update cost more than the budget or left items
+    // behind, back while it costs less than half; cost and budget in milliseconds, or in items where the
+    // choices have to be reproducible
+    void Adapt(double cost, double budget);
+    inline int getBias() const { return this->mBias; }
+};
+
+
+#endif //PROJECT_STAGGEREDUPDATE_H
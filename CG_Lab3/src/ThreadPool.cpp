@@ -0,0 +1,85 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads) : mNext(0) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < threads; ++i)
+        this->mWorkers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mMutex);
+        this->mStop = true;
+    }
+    this->mWake.notify_all();
+    for (std::thread &worker : this->mWorkers)
+        worker.join();
+}
+
+void ThreadPool::RunChunks() {
+    while (true)
+    {
+        size_t begin = this->mNext.fetch_add(this->mGrain);
+        if (begin >= this->mCount)
+            return;
+        size_t end = std::min(begin + this->mGrain, this->mCount);
+        (*this->mJob)(begin, end);
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    unsigned seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->mMutex);
+            this->mWake.wait(lock, [&] { return this->mStop || this->mGeneration != seen; });
+            if (this->mStop)
+                return;
+            seen = this->mGeneration;
+        }
+
+        this->RunChunks();
+
+        std::lock_guard<std::mutex> lock(this->mMutex);
+        if (--this->mBusy == 0)
+            this->mDone.notify_one();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    if (count == 0)
+        return;
+    if (grain == 0)
+        grain = 1;
+    // not worth waking anybody
+    if (this->mWorkers.empty() || count <= grain)
+    {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mMutex);
+        this->mJob = &fn;
+        this->mCount = count;
+        this->mGrain = grain;
+        this->mNext.store(0);
+        this->mBusy = unsigned(this->mWorkers.size());
+        ++this->mGeneration;
+    }
+    this->mWake.notify_all();
+
+    this->RunChunks();
+
+    std::unique_lock<std::mutex> lock(this->mMutex);
+    this->mDone.wait(lock, [&] { return this->mBusy == 0; });
+    this->mJob = nullptr;
+}
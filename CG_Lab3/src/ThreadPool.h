@@ -0,0 +1,49 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_THREADPOOL_H
+#define PROJECT_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// fixed set of worker threads reused by every parallel pass of a frame
+class ThreadPool {
+private:
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+
+    const std::function<void(size_t, size_t)> *mJob = nullptr;
+    std::atomic<size_t> mNext;
+    size_t mCount = 0;
+    size_t mGrain = 1;
+    unsigned mGeneration = 0;
+    unsigned mBusy = 0;
+    bool mStop = false;
+
+    void WorkerLoop();
+    void RunChunks();
+public:
+    // threads == 0 uses every hardware thread
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // number of threads taking part in a pass, the caller included
+    inline unsigned Size() const { return unsigned(this->mWorkers.size()) + 1; }
+
+    // calls fn(begin, end) on chunks of [0, count) and returns when all of them are done
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+};
+
+
+#endif //PROJECT_THREADPOOL_H
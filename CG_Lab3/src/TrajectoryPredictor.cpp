@@ -0,0 +1,278 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "TrajectoryPredictor.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// the worker sleeps at most this long when no request arrived
+#define PREDICTOR_IDLE_MS 2
+// times this close below a sample count as on it
+#define PREDICTOR_GRID_EPSILON 1e-6
+
+TrajectoryPredictor::TrajectoryPredictor(double horizon, double step, unsigned threads)
+        : mHorizon(horizon), mStep(step), mPool(threads), mStop(false) {
+    // the sample at or before the current time is kept as the start of the interpolation
+    this->mCapacity = size_t(std::ceil(horizon / step)) + 3;
+    this->mThread = std::thread(&TrajectoryPredictor::WorkerLoop, this);
+}
+
+TrajectoryPredictor::~TrajectoryPredictor() {
+    this->mStop = true;
+    this->mWake.notify_one();
+    this->mThread.join();
+}
+
+void TrajectoryPredictor::Invalidate(size_t body) {
+    if (body >= this->mVersions.size())
+        this->mVersions.resize(body + 1, 0);
+    ++this->mVersions[body];
+}
+
+void TrajectoryPredictor::Submit(const Bodies &bodies, double time) {
+    Request &request = this->mRequests.Back();
+    request.x = bodies.x;
+    request.y = bodies.y;
+    request.z = bodies.z;
+    request.vx = bodies.vx;
+    request.vy = bodies.vy;
+    request.vz = bodies.vz;
+    request.mass = bodies.mass;
+    request.radius = bodies.radius;
+    this->mVersions.resize(bodies.Size(), 0);
+    request.versions = this->mVersions;
+    request.time = time;
+    this->mRequests.Publish();
+    // no lock: a missed wake-up only costs the idle timeout
+    this->mWake.notify_one();
+}
+
+void TrajectoryPredictor::WorkerLoop() {
+    while (!this->mStop)
+    {
+        if (this->mRequests.Acquire()) {
+            this->Update(this->mRequests.Front());
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(this->mMutex);
+        this->mWake.wait_for(lock, std::chrono::milliseconds(PREDICTOR_IDLE_MS));
+    }
+}
+
+void TrajectoryPredictor::Push(Track &track, const glm::vec3 &position) const {
+    if (track.count == this->mCapacity) {
+        track.head = (track.head + 1) % this->mCapacity;
+        ++track.first;
+        --track.count;
+    }
+    track.ring[(track.head + track.count) % this->mCapacity] = position;
+    ++track.count;
+}
+
+void TrajectoryPredictor::DropBefore(Track &track, int64_t k) const {
+    while (track.count > 1 && track.first < k)
+    {
+        track.head = (track.head + 1) % this->mCapacity;
+        ++track.first;
+        --track.count;
+    }
+}
+
+// acceleration from the attractors at grid index k, fraction in [0, 1] interpolates towards k + 1
+glm::vec3 TrajectoryPredictor::Field(const glm::vec3 &position, int64_t k, float fraction) const {
+    glm::vec3 acceleration(0.0f);
+    for (uint32_t a : this->mAttractors)
+    {
+        const Track &track = this->mTracks[a];
+        glm::vec3 source = this->Sample(track, k);
+        if (fraction > 0.0f)
+            source = glm::mix(source, this->Sample(track, k + 1), fraction);
+        glm::vec3 d = source - position;
+        float r2 = glm::dot(d, d) + SOFTENING * SOFTENING;
+        acceleration += d * (GRAVITY * this->mMass[a] / (r2 * std::sqrt(r2)));
+    }
+    return acceleration;
+}
+
+void TrajectoryPredictor::Reset(const Request &request) {
+    size_t n = request.x.size();
+    this->mOrigin = request.time;
+    this->mTracks.resize(n);
+    this->mMass = request.mass;
+    for (size_t i = 0; i < n; ++i)
+    {
+        Track &track = this->mTracks[i];
+        track.ring.resize(this->mCapacity);
+        track.head = 0;
+        track.count = 0;
+        track.first = 0;
+        track.position = glm::vec3(request.x[i], request.y[i], request.z[i]);
+        track.velocity = glm::vec3(request.vx[i], request.vy[i], request.vz[i]);
+        track.version = request.versions[i];
+        this->Push(track, track.position);
+    }
+}
+
+// starts a light body from its current state: a partial step onto the grid, then whole steps
+void TrajectoryPredictor::Restart(const Request &request, uint32_t body, int64_t now) {
+    Track &track = this->mTracks[body];
+    glm::vec3 position(request.x[body], request.y[body], request.z[body]);
+    glm::vec3 velocity(request.vx[body], request.vy[body], request.vz[body]);
+    double next = this->mOrigin + double(now + 1) * this->mStep;
+    float dt = float(next - request.time);
+    float fraction = std::max(float((request.time - this->mOrigin) / this->mStep - double(now)), 0.0f);
+
+    velocity += this->Field(position, now, fraction) * (0.5f * dt);
+    position += velocity * dt;
+    velocity += this->Field(position, now + 1, 0.0f) * (0.5f * dt);
+
+    track.head = 0;
+    track.count = 0;
+    track.first = now + 1;
+    track.position = position;
+    track.velocity = velocity;
+    track.version = request.versions[body];
+    this->Push(track, position);
+}
+
+// one leapfrog step of the attractors among themselves
+void TrajectoryPredictor::StepAttractors() {
+    float h = float(this->mStep);
+    size_t count = this->mAttractors.size();
+    std::vector<glm::vec3> acceleration(count);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            acceleration[i] = glm::vec3(0.0f);
+            const glm::vec3 &p = this->mTracks[this->mAttractors[i]].position;
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (i == j)
+                    continue;
+                glm::vec3 d = this->mTracks[this->mAttractors[j]].position - p;
+                float r2 = glm::dot(d, d) + SOFTENING * SOFTENING;
+                acceleration[i] += d * (GRAVITY * this->mMass[this->mAttractors[j]] / (r2 * std::sqrt(r2)));
+            }
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            Track &track = this->mTracks[this->mAttractors[i]];
+            track.velocity += acceleration[i] * (0.5f * h);
+            if (pass == 0)
+                track.position += track.velocity * h;
+        }
+    }
+    for (uint32_t a : this->mAttractors)
+        this->Push(this->mTracks[a], this->mTracks[a].position);
+}
+
+void TrajectoryPredictor::ExtendLight(uint32_t body, int64_t last) {
+    Track &track = this->mTracks[body];
+    float h = float(this->mStep);
+    for (int64_t k = this->Last(track); k < last; ++k)
+    {
+        track.velocity += this->Field(track.position, k, 0.0f) * (0.5f * h);
+        track.position += track.velocity * h;
+        track.velocity += this->Field(track.position, k + 1, 0.0f) * (0.5f * h);
+        this->Push(track, track.position);
+    }
+}
+
+void TrajectoryPredictor::Update(const Request &request) {
+    auto start = std::chrono::steady_clock::now();
+    size_t n = request.x.size();
+    if (n == 0)
+        return;
+
+    float heaviest = *std::max_element(request.mass.begin(), request.mass.end());
+    std::vector<uint32_t> attractors;
+    for (size_t i = 0; i < n; ++i)
+        if (request.mass[i] >= PREDICTOR_ATTRACTOR_FRACTION * heaviest)
+            attractors.push_back(uint32_t(i));
+
+    // sample at or before the current time
+    auto Deviates = [&](uint32_t i, int64_t now) {
+        const Track &track = this->mTracks[i];
+        if (now < track.first || now + 1 > this->Last(track))
+            return true;
+        float fraction = std::max(float((request.time - this->mOrigin) / this->mStep - double(now)), 0.0f);
+        glm::vec3 predicted = glm::mix(this->Sample(track, now), this->Sample(track, now + 1), fraction);
+        glm::vec3 actual(request.x[i], request.y[i], request.z[i]);
+        return glm::length(actual - predicted) > PREDICTOR_TOLERANCE * request.radius[i];
+    };
+
+    int64_t now = int64_t(std::floor((request.time - this->mOrigin) / this->mStep + PREDICTOR_GRID_EPSILON));
+    bool reset = this->mTracks.size() != n || attractors != this->mAttractors || request.time < this->mOrigin;
+    for (size_t a = 0; !reset && a < attractors.size(); ++a)
+        reset = request.versions[attractors[a]] != this->mTracks[attractors[a]].version
+                || request.mass[attractors[a]] != this->mMass[attractors[a]] || Deviates(attractors[a], now);
+    if (reset) {
+        this->mAttractors = attractors;
+        this->Reset(request);
+        now = 0;
+    }
+    this->mLight.clear();
+    for (size_t i = 0; i < n; ++i)
+        if (request.mass[i] < PREDICTOR_ATTRACTOR_FRACTION * heaviest)
+            this->mLight.push_back(uint32_t(i));
+
+    // the attractors reach one step past the horizon, so the light bodies can always interpolate
+    int64_t last = now + int64_t(std::ceil(this->mHorizon / this->mStep)) + 1;
+    for (uint32_t a : this->mAttractors)
+        this->DropBefore(this->mTracks[a], now);
+    while (this->Last(this->mTracks[this->mAttractors.front()]) < last)
+        this->StepAttractors();
+
+    // light bodies only depend on the attractors, each one is extended or restarted on its own
+    std::vector<char> restarted(n, 0);
+    this->mPool.ParallelFor(this->mLight.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t l = begin; l < end; ++l)
+        {
+            uint32_t i = this->mLight[l];
+            Track &track = this->mTracks[i];
+            if (reset || track.version != request.versions[i] || Deviates(i, now)) {
+                this->Restart(request, i, now);
+                restarted[i] = 1;
+            } else {
+                this->DropBefore(track, now);
+            }
+            this->ExtendLight(i, last);
+        }
+    });
+
+    size_t count = reset ? n : size_t(std::count(restarted.begin(), restarted.end(), 1));
+    this->Publish(request, count, Milliseconds(start));
+}
+
+void TrajectoryPredictor::Publish(const Request &request, size_t restarted, double workMs) {
+    Polylines &polylines = this->mPolylines.Back();
+    size_t n = this->mTracks.size();
+    polylines.vertices.clear();
+    polylines.first.resize(n);
+    polylines.count.resize(n);
+    double position = (request.time - this->mOrigin) / this->mStep;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Track &track = this->mTracks[i];
+        polylines.first[i] = int(polylines.vertices.size() / 3);
+        // the line starts at the body itself, then follows the samples ahead of it
+        polylines.vertices.insert(polylines.vertices.end(), { request.x[i], request.y[i], request.z[i] });
+        int64_t k = std::max(track.first, int64_t(std::floor(position + PREDICTOR_GRID_EPSILON)) + 1);
+        for (; k <= this->Last(track); ++k)
+        {
+            const glm::vec3 &p = this->Sample(track, k);
+            polylines.vertices.insert(polylines.vertices.end(), { p.x, p.y, p.z });
+        }
+        polylines.count[i] = int(polylines.vertices.size() / 3) - polylines.first[i];
+    }
+    polylines.time = request.time;
+    polylines.generation = ++this->mGeneration;
+    polylines.restarted = restarted;
+    polylines.workMs = workMs;
+    this->mPolylines.Publish();
+}
@@ -0,0 +1,111 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_TRAJECTORYPREDICTOR_H
+#define PROJECT_TRAJECTORYPREDICTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bodies.h"
+#include "ThreadPool.h"
+#include "TripleBuffer.h"
+
+// bodies at least this fraction of the heaviest mass pull on the others in the prediction
+#define PREDICTOR_ATTRACTOR_FRACTION 1e-3f
+// a body is re-predicted when it strays this many radii from its predicted path
+#define PREDICTOR_TOLERANCE 0.25f
+
+// future paths of all bodies, one line strip per body starting at its position at time
+struct Polylines
+{
+    std::vector<float> vertices;        // xyz
+    std::vector<int> first;             // per body, in vertices
+    std::vector<int> count;
+    double time = 0.0;
+    uint64_t generation = 0;
+    size_t restarted = 0;               // bodies integrated from scratch by this update
+    double workMs = 0.0;
+};
+
+
+// integrates future paths on its own threads and hands finished polylines to the render thread.
+// massive bodies are predicted together; every other body moves in their field on its own,
+// so a change to a light body only re-predicts that body
+class TrajectoryPredictor {
+private:
+    struct Request
+    {
+        std::vector<float> x, y, z, vx, vy, vz, mass, radius;
+        std::vector<uint32_t> versions;
+        double time = 0.0;
+    };
+    // ring of positions on the global sample grid, index k is at mOrigin + k * mStep
+    struct Track
+    {
+        std::vector<glm::vec3> ring;
+        size_t head = 0, count = 0;
+        int64_t first = 0;                // grid index of the oldest sample
+        glm::vec3 position, velocity;     // state at the newest sample
+        uint32_t version = 0;
+    };
+
+    const double mHorizon;
+    const double mStep;
+    size_t mCapacity;
+
+    // render thread side
+    std::vector<uint32_t> mVersions;
+    TripleBuffer<Request> mRequests;
+    TripleBuffer<Polylines> mPolylines;
+
+    // worker side
+    ThreadPool mPool;
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::atomic<bool> mStop;
+    double mOrigin = 0.0;
+    std::vector<Track> mTracks;
+    std::vector<uint32_t> mAttractors, mLight;
+    std::vector<float> mMass;
+    uint64_t mGeneration = 0;
+
+    void WorkerLoop();
+    void Update(const Request &request);
+    void Publish(const Request &request, size_t restarted, double workMs);
+    void Reset(const Request &request);
+    void Restart(const Request &request, uint32_t body, int64_t now);
+    void StepAttractors();
+    void ExtendLight(uint32_t body, int64_t last);
+    glm::vec3 Field(const glm::vec3 &position, int64_t k, float fraction) const;
+
+    inline const glm::vec3 &Sample(const Track &track, int64_t k) const {
+        return track.ring[(track.head + size_t(k - track.first)) % this->mCapacity];
+    }
+    inline int64_t Last(const Track &track) const { return track.first + int64_t(track.count) - 1; }
+    void Push(Track &track, const glm::vec3 &position) const;
+    void DropBefore(Track &track, int64_t k) const;
+public:
+    // horizon and step in simulated seconds
+    TrajectoryPredictor(double horizon, double step, unsigned threads = 1);
+    ~TrajectoryPredictor();
+    TrajectoryPredictor(const TrajectoryPredictor &) = delete;
+    TrajectoryPredictor &operator=(const TrajectoryPredictor &) = delete;
+
+    // render thread: the body changed in a way its prediction cannot know about
+    void Invalidate(size_t body);
+    // render thread: current state, copied and handed over without waiting
+    void Submit(const Bodies &bodies, double time);
+    // render thread: takes the newest finished polylines, false when there are none since the last call
+    inline bool Acquire() { return this->mPolylines.Acquire(); }
+    inline const Polylines &getPolylines() const { return this->mPolylines.Front(); }
+};
+
+
+#endif //PROJECT_TRAJECTORYPREDICTOR_H
@@ -0,0 +1,42 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_TRIPLEBUFFER_H
+#define PROJECT_TRIPLEBUFFER_H
+
+#include <atomic>
+
+// single producer, single consumer hand-off of the latest value; neither side ever blocks.
+// the producer fills Back() and publishes it, the consumer takes the newest published slot
+template <typename T>
+class TripleBuffer {
+private:
+    static const unsigned FRESH = 4;
+
+    T mSlots[3];
+    std::atomic<unsigned> mMiddle;    // slot index, FRESH when the consumer has not taken it yet
+    unsigned mBack = 0;               // owned by the producer
+    unsigned mFront = 2;              // owned by the consumer
+public:
+    TripleBuffer() : mMiddle(1) {}
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    inline T &Back() { return this->mSlots[this->mBack]; }
+    inline void Publish() {
+        this->mBack = this->mMiddle.exchange(this->mBack | FRESH, std::memory_order_acq_rel) & 3;
+    }
+
+    // swaps in the newest published value, false when nothing new arrived
+    inline bool Acquire() {
+        if (!(this->mMiddle.load(std::memory_order_acquire) & FRESH))
+            return false;
+        this->mFront = this->mMiddle.exchange(this->mFront, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+    inline const T &Front() const { return this->mSlots[this->mFront]; }
+};
+
+
+#endif //PROJECT_TRIPLEBUFFER_H
@@ -0,0 +1,23 @@
+//
+// Created by max on 19.10.26.
+//
+
+#include "UniformBuffer.h"
+#include "ErrorChecker.h"
+
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding) {
+    GLCall(glGenBuffers(1, &this->mID));
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, this->mID));
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW));
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, this->mID));
+}
+
+UniformBuffer::~UniformBuffer() {
+    GLCall(glDeleteBuffers(1, &this->mID));
+}
+
+void UniformBuffer::Update(const void *data, unsigned int size) {
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, this->mID));
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, data, GL_STREAM_DRAW));
+}
@@ -0,0 +1,22 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_UNIFORMBUFFER_H
+#define PROJECT_UNIFORMBUFFER_H
+
+
+// storage of a uniform block at one buffer binding, filled with the std140 struct of the generated
+// ShaderUniforms.h in a single copy instead of a glUniform call per value
+class UniformBuffer {
+private:
+    unsigned int mID;
+public:
+    UniformBuffer(unsigned int size, unsigned int binding);
+    ~UniformBuffer();
+    // replaces the whole block, the old storage is orphaned so the draws in flight keep it
+    void Update(const void* data, unsigned int size);
+};
+
+
+#endif //PROJECT_UNIFORMBUFFER_H
@@ -0,0 +1,21 @@
+//
+// Created by max on 19.10.26.
+//
+
+#ifndef PROJECT_UNIFORMHASH_H
+#define PROJECT_UNIFORMHASH_H
+
+#include <cstdint>
+
+// FNV-1a of a uniform name, the key Shader keeps its uniforms under. constexpr, so names known
+// at compile time (the ids of the generated ShaderUniforms.h) are hashed by the compiler
+constexpr uint32_t UniformHash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; ++name)
+        hash = (hash ^ uint8_t(*name)) * 16777619u;
+    return hash;
+}
+
+
+#endif //PROJECT_UNIFORMHASH_H
@@ -16,6 +16,11 @@ VertexBuffer::~VertexBuffer() {
     GLCall(glDeleteBuffers(1, &m_ID));
 }
 
+void VertexBuffer::Update(const void *data, unsigned int size) {
+    Bind();
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW));
+}
+
 void VertexBuffer::Bind() const {
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_ID));
 }
@@ -12,6 +12,8 @@ private:
 public:
     VertexBuffer(const void* data, unsigned int size);
     ~VertexBuffer();
+    // replaces the contents, the old storage is orphaned so the draw in flight keeps it
+    void Update(const void* data, unsigned int size);
     void Bind() const;
     void Unbind() const;
 };
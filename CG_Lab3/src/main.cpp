@@ -8,6 +8,32 @@
 #include "Sphere.h"
 #include "Shader.h"
 #include "ErrorChecker.h"
+#include "NBody.h"
+#include "Integrator.h"
+#include "KeplerOrbits.h"
+#include "GpuNBody.h"
+#include "Ephemeris.h"
+#include "Collision.h"
+#include "Bvh.h"
+#include "LooseOctree.h"
+#include "TrajectoryPredictor.h"
+#include "Clock.h"
+#include "Scheduler.h"
+#include "StaggeredUpdate.h"
+#include "Snapshot.h"
+#include "KeyframeCache.h"
+#include "Headless.h"
+#include "CameraPath.h"
+#include "FrameProfiler.h"
+#include "InputSource.h"
+#include "GLIntercept.h"
+#include "NullGL.h"
+#include "ProgramCache.h"
+#include "ShaderWatcher.h"
+#include "ShaderVariants.h"
+#include "ShaderBatch.h"
+#include "UniformBuffer.h"
+#include "ShaderUniforms.h"
 // glm
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -15,15 +41,61 @@
 // stb_image
 #include "stb_image.h"
 
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <unistd.h>
+
 #define PI 3.14159265359f
 #define TIMER 2.0f
+#define MAX_STEP 0.05f
+// asteroid belt added to the GPU copy of the system
+#define GPU_BELT 16384
+// largest compute substep in simulated seconds; a frame is at most GPU_MAX_SUBSTEPS of them,
+// higher time warps are saturated rather than stretching the substep
+#define GPU_STEP 0.01f
+#define GPU_MAX_SUBSTEPS 32
+// ephemeris table, fitted from the Kepler orbits when the file is missing or was fitted from anything else
+#define EPHEMERIS_PATH "../res/Ephemeris.bin"
+#define EPHEMERIS_SPAN 3600.0
+#define EPHEMERIS_SEGMENTS 1800
+#define EPHEMERIS_COEFFICIENTS 12
+// predicted paths, simulated seconds ahead and between samples
+#define PREDICTOR_HORIZON 12.0
+#define PREDICTOR_STEP 0.02
+// per-frame work: the frame budget, the orbit update budget and the path refresh rate
+#define FRAME_BUDGET_MS 4.0
+#define ORBIT_BUDGET_MS 1.0
+#define ORBIT_LEVELS 5
+#define ORBIT_NEAR_DISTANCE 40.0f
+// due orbits solved together in SIMD batches, the clock is looked at between two batches
+#define ORBIT_BATCH 64
+// while recording or replaying, orbits keyed and interpolated per frame replace the time budget,
+// so that the replay keys, carries and re-levels the same orbits as the recording
+#define ORBIT_REPLAY_KEYS 4096
+#define ORBIT_REPLAY_INTERPOLATED 65536
+#define PREDICTOR_RATE 20.0f
+// snapshot slots 1-4, Shift+digit saves and the digit alone restores
+#define SNAPSHOT_PATH "../res/Snapshot"
+
+#define PROGRAM_CACHE_PATH "../res/ProgramCache"
+#define SHADER_DIRECTORY "../res"
+// integrated history: a keyframe every half simulated second, 64 per segment, at most 64 MB
+#define KEYFRAME_INTERVAL 0.5
+#define KEYFRAME_SEGMENT 64
+#define KEYFRAME_CAPACITY (64u << 20)
+// simulated seconds per real second while scrubbing, times the time warp
+#define SCRUB_RATE 2.0f
 
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow *window);
+void processInput(GLFWwindow *window, const InputSource &input);
+void handleEvent(GLFWwindow *window, const InputEvent &event);
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods, double x, double y);
+void recalculateCameraPos();
 
 unsigned int loadTexture(char const* path);
 std::vector<float> drawSphere(float fRadius, int iSlices, int iStacks);
@@ -54,40 +126,115 @@ float fov = 45.0f;
 bool perspective = true;
 // move mode
 bool move = true;
-
-int main() {
-    // glfw init
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // create window
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Solar system", nullptr, nullptr);
-    if (window == nullptr) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
+// gravity kernel, G cycles through them
+GravityKernel gravityKernel = GravityKernel::AUTO;
+// analytic Kepler orbits or integrated gravity, K switches
+bool analytic = true;
+// integrator for the gravity mode, I cycles through them
+IntegratorType integratorType = IntegratorType::LEAPFROG;
+// simulated seconds per real second, +/- multiply or divide by 10
+float timeWarp = 1.0f;
+// compute-shader N-body with an asteroid belt, C switches
+bool gpu = false;
+// picking mode frees the cursor, a left click selects the body under it; B switches
+bool picking = false;
+bool pickRequested = false;
+double pickX = 0.0, pickY = 0.0;          // relative to the window size
+// predicted paths of the CPU bodies, T switches
+bool paths = true;
+// Phong highlights on Earth, a shader variant compiled on first use; L switches
+bool specular = false;
+// snapshot slot to save or restore on the next frame, 0 for none
+int snapshotSlot = 0;
+bool snapshotSave = false;
+// timeline scrubbing freezes the simulation, Z switches and [ ] move through the history
+bool scrubbing = false;
+float scrubDirection = 0.0f;
+
+int main(int argc, char **argv) {
+    HeadlessOptions headless;
+    if (!HeadlessOptions::Parse(argc, argv, headless))
         return -1;
+
+    // offscreen: fixed frames into a framebuffer object, no window and no input
+    HeadlessContext offscreen;
+    GLFWwindow *window = nullptr;
+    if (headless.enabled) {
+        SCR_WIDTH = headless.width;
+        SCR_HEIGHT = headless.height;
+        // the null backend measures what the CPU submits, without a driver behind it
+        if (headless.nullGL ? !gladLoadGLLoader((GLADloadproc) NullGLLoader) : !offscreen.Create(SCR_WIDTH, SCR_HEIGHT))
+            return -1;
+    } else {
+        // glfw init
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_ERROR_POLICY == GL_ERRORS_CALLBACK ? GLFW_TRUE : GLFW_FALSE);
+
+        // create window, 4.5 for compute shaders and 3.3 if the driver has nothing newer
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Solar system", nullptr, nullptr);
+        if (window == nullptr) {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Solar system", nullptr, nullptr);
+        }
+        if (window == nullptr) {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        // glad init
+        if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
     }
-    glfwMakeContextCurrent(window);
-    // callback functions
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, cursor_position_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-    glfwSetKeyCallback(window, key_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    // glad init
-    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
+
+    // every GL call counted and timed from here on, the entry points stay untouched without the option
+    if (headless.glStats && !GLIntercept::Enable(headless.glTrace))
+        return -1;
+
+#if GL_ERROR_POLICY == GL_ERRORS_CALLBACK
+    // asynchronous, the driver reports when it finds out; synchronous gives the stack of the failing call
+    EnableDebugOutput(false);
+#endif
+
+    // frame time and input come from one place, so a session can be recorded and replayed exactly
+    InputSource input(headless.enabled ? InputSource::Mode::FIXED : InputSource::Mode::LIVE, headless.step);
+    if (window != nullptr)
+        input.Attach(window);
+    if (!headless.replay.empty() && !input.Replay(headless.replay))
+        return -1;
+    if (!headless.record.empty() && !input.Record(headless.record))
         return -1;
-    }
 
     // init models
     GLCall(glEnable(GL_DEPTH_TEST););
     GLCall(glEnable(GL_LINE_SMOOTH););
     GLCall(glLineWidth(4););
 
+    // read shaders and submit their programs, the driver compiles them while the rest loads and the
+    // scene draws with the fallback; linked programs of earlier runs come from the cache
+    if (headless.programCache)
+        ProgramCache::setDirectory(PROGRAM_CACHE_PATH);
+    // camera and light of every scene shader come from one buffer, written once a frame
+    Shader::setBlockBinding(Uniforms::FrameBlock::Name, Uniforms::FrameBlock::Binding, sizeof(Uniforms::FrameBlock));
+    UniformBuffer frameUBO(sizeof(Uniforms::FrameBlock), Uniforms::FrameBlock::Binding);
+    auto shadersStart = std::chrono::steady_clock::now();
+    ShaderBatch shaderBatch("../res/Fallback.shader");
+    ShaderVariants EarthVariants("../res/Earth.shader");
+    Shader *EarthShader = &EarthVariants.Get({}, &shaderBatch);
+    Shader SunShader("../res/Sun.shader", {}, &shaderBatch);
+    Shader OrbitShader("../res/Orbit.shader", {}, &shaderBatch);
+    std::cout << "Programs submitted in "
+              << Milliseconds(shadersStart)
+              << " ms, " << ProgramCache::getHits() << " from cache" << std::endl;
+
     // spheres
     VertexArray EarthVAO, SunVAO;
     EarthVAO.Unbind();
@@ -125,17 +272,45 @@ int main() {
     }
     SunVAO.Unbind();
 
+    // low-poly sphere for the belt instances
+    VertexArray BeltVAO;
+    BeltVAO.Unbind();
+
+    Sphere beltSphere(8, 8);
+    VertexBuffer beltVBO(beltSphere.getVertices().data(), beltSphere.getVertices().size()*sizeof(float));
+    ElementBuffer beltIBO(beltSphere.getIndices().data(), beltSphere.getIndices().size()*sizeof(unsigned int));
+
+    BeltVAO.Bind();
+    {
+        // positions
+        GLCall( glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8*sizeof(float), (void*) 0); );
+        GLCall( glEnableVertexAttribArray(0); );
+        // normals
+        GLCall( glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8*sizeof(float), (void*) (3 * sizeof(float))); );
+        GLCall( glEnableVertexAttribArray(1); );
+        // texture coord
+        GLCall( glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8*sizeof(float), (void*) (6 * sizeof(float))); );
+        GLCall( glEnableVertexAttribArray(2); );
+    }
+    BeltVAO.Unbind();
+
     // texture
     const unsigned int SunTexture = loadTexture("../res/Sun.jpg");
     const unsigned int EarthTexture = loadTexture("../res/Earth.bmp");
     const unsigned int DarkSunTexture = loadTexture("../res/DarkSun.jpg");
 
-    // read and create shaders
-    Shader EarthShader("../res/Earth.shader");
-    Shader SunShader("../res/Sun.shader");
+    Uniforms::Earth EarthUniforms(*EarthShader);
+    Uniforms::Sun SunUniforms(SunShader);
+    Uniforms::Orbit OrbitUniforms(OrbitShader);
+    bool earthSpecular = false;
+
+    // saved .shader files are parsed on the watcher thread and swapped in between frames
+    ShaderWatcher shaderWatcher;
+    if (!headless.enabled || headless.watchShaders)
+        shaderWatcher.Start(SHADER_DIRECTORY);
 
-    EarthShader.Use();
-    EarthShader.NotUse();
+    EarthShader->Use();
+    EarthShader->NotUse();
     SunShader.Use();
     SunShader.NotUse();
 
@@ -149,19 +324,411 @@ int main() {
     glm::vec3 zeros(0.0f);
     glm::vec3 ourColor(0.3f, 0.5f, 0.5f);
 
+    // bodies: Sun in the centre and Earth on a circular orbit of radius 20 with 1 rad/s
+    ThreadPool pool;
+    NBody nbody(pool);
+    Integrator integrator(nbody);
+    Collision collision(pool);
+    Bvh bvh;
+    // spatial index of the CPU bodies, the frustum query decides what is drawn
+    LooseOctree octree(glm::vec3(0.0f), 512.0f);
+    std::vector<uint32_t> visibleIds;
+    std::vector<char> visible;
+    Bodies &bodies = nbody.getBodies();
+    const size_t Sun = bodies.Add(glm::vec3(0.0f), glm::vec3(0.0f), 8000.0f, 5.0f);
+    const size_t Earth = bodies.Add(glm::vec3(0.0f, 0.0f, 20.0f), glm::vec3(20.0f, 0.0f, 0.0f), 0.01f, 2.0f);
+
+    // the same orbit as elements, orbit i drives body Earth + i
+    KeplerOrbits orbits(bodies.mass[Sun]);
+    orbits.Add({ 20.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f });
+
+    // precomputed positions for the same bodies, the analytic mode uses them inside the table span
+    // a table fitted from other orbits or with other parameters is fitted again
+    Ephemeris ephemeris;
+    uint64_t ephemerisKey = Ephemeris::Key(orbits.Key(), EPHEMERIS_COEFFICIENTS, 0.0, EPHEMERIS_SPAN, EPHEMERIS_SEGMENTS);
+    if (access(EPHEMERIS_PATH, R_OK) == 0 && ephemeris.Open(EPHEMERIS_PATH)
+        && (ephemeris.getKey() != ephemerisKey || ephemeris.getBodyCount() != orbits.Size())) {
+        std::cout << "Ephemeris " << EPHEMERIS_PATH << " is out of date, fitting it again" << std::endl;
+        ephemeris.Close();
+    }
+    if (!ephemeris.IsOpen()
+        && Ephemeris::Fit(EPHEMERIS_PATH, orbits.Size(), EPHEMERIS_COEFFICIENTS, 0.0, EPHEMERIS_SPAN, EPHEMERIS_SEGMENTS,
+                          orbits.Key(), [&orbits](double t, float *x, float *y, float *z) { orbits.Propagate(t, x, y, z); }))
+        ephemeris.Open(EPHEMERIS_PATH);
+    double simTime = 0.0;
+    bool integrating = false;
+
+    // GPU copy of the system, created when first switched on
+    std::unique_ptr<GpuNBody> gpuNBody;
+    bool gpuSaturated = false;
+    // lit planets and belt, and the emissive Sun
+    std::unique_ptr<ShaderVariants> BodiesVariants;
+    Shader *BodiesShader = nullptr, *BodiesSunShader = nullptr;
+    Uniforms::Bodies BodiesUniforms, BodiesSunUniforms;
+    size_t planets = 0;
+    // locations differ per program, after a reload or a linked program replacing the fallback
+    auto resolveUniforms = [&]() {
+        EarthUniforms = Uniforms::Earth(*EarthShader);
+        SunUniforms = Uniforms::Sun(SunShader);
+        OrbitUniforms = Uniforms::Orbit(OrbitShader);
+        if (BodiesVariants) {
+            BodiesUniforms = Uniforms::Bodies(*BodiesShader);
+            BodiesSunUniforms = Uniforms::Bodies(*BodiesSunShader);
+        }
+    };
+
+    // future paths come from a background thread, the frame only draws the newest ones
+    TrajectoryPredictor predictor(PREDICTOR_HORIZON, PREDICTOR_STEP);
+    glm::vec3 orbitColor(0.4f, 0.6f, 0.9f);
+    VertexArray OrbitVAO;
+    VertexBuffer orbitVBO(nullptr, 0);
+    OrbitVAO.Bind();
+    {
+        // positions
+        GLCall( glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), (void*) 0); );
+        GLCall( glEnableVertexAttribArray(0); );
+    }
+    OrbitVAO.Unbind();
+    orbitVBO.Unbind();
+    uint64_t orbitGeneration = 0;
+
+    // recorded history of the integrated mode, scrubbing reads it instead of integrating again
+    KeyframeCache keyframes(KEYFRAME_INTERVAL, KEYFRAME_SEGMENT, KEYFRAME_CAPACITY);
+    bool wasScrubbing = false;
+    double liveTime = 0.0;
+    // state at time integrated again from the keyframe before it, approximate since the substeps differ
+    // from the recorded run; false when the history does not reach back
+    auto Reconstruct = [&](double time) {
+        double keyTime;
+        if (!keyframes.Nearest(time, bodies, keyTime))
+            return false;
+        integrator.setWarp(1.0f);
+        integrator.Advance(float(time - keyTime));
+        return true;
+    };
+
+    // systems that do not need to run at the frame rate
+    Scheduler scheduler(FRAME_BUDGET_MS);
+    bool reproducible = input.IsRecording() || input.IsReplaying();
+    scheduler.setDeterministic(reproducible);
+    float frameSimStep = 0.0f;
+    // far orbits are recomputed every few frames and interpolated in between
+    StaggeredUpdate staggered(ORBIT_LEVELS, ORBIT_NEAR_DISTANCE);
+    size_t orbitSystem = scheduler.Add("orbits", 0.0f, ORBIT_BUDGET_MS, [&](float) {
+        auto start = std::chrono::steady_clock::now();
+        staggered.Resize(orbits.Size());
+        glm::vec3 focus = bodies.Position(Sun);
+        const std::vector<uint32_t> &due = staggered.Due(scheduler.getFrame(), [&](uint32_t i) {
+            return glm::length(bodies.Position(Earth + i) - cameraPos);
+        });
+        // what the budget does not reach is carried into the next frame
+        size_t done = 0;
+        while (done < due.size()) {
+            if (done > 0 && (reproducible ? done >= ORBIT_REPLAY_KEYS : Milliseconds(start) > ORBIT_BUDGET_MS))
+                break;
+            const uint32_t *batch = &due[done];
+            size_t count = std::min(due.size() - done, size_t(ORBIT_BATCH));
+            double target[ORBIT_BATCH];
+            float x[ORBIT_BATCH], y[ORBIT_BATCH], z[ORBIT_BATCH], vx[ORBIT_BATCH], vy[ORBIT_BATCH], vz[ORBIT_BATCH];
+            for (size_t k = 0; k < count; ++k)
+                target[k] = simTime + double(staggered.Frames(batch[k]) - 1) * frameSimStep;
+            orbits.Propagate(batch, target, count, x, y, z, vx, vy, vz);
+            // inside the table the fitted positions replace the solved ones
+            uint32_t inside[ORBIT_BATCH], at[ORBIT_BATCH];
+            double insideTarget[ORBIT_BATCH];
+            float ex[ORBIT_BATCH], ey[ORBIT_BATCH], ez[ORBIT_BATCH];
+            size_t covered = 0;
+            for (size_t k = 0; k < count; ++k)
+                if (ephemeris.Covers(target[k])) {
+                    inside[covered] = batch[k];
+                    insideTarget[covered] = target[k];
+                    at[covered++] = uint32_t(k);
+                }
+            if (covered > 0)
+                ephemeris.Evaluate(inside, insideTarget, covered, ex, ey, ez);
+            for (size_t j = 0; j < covered; ++j) {
+                x[at[j]] = ex[j];
+                y[at[j]] = ey[j];
+                z[at[j]] = ez[j];
+            }
+            glm::vec3 sunVelocity = bodies.Velocity(Sun);
+            for (size_t k = 0; k < count; ++k) {
+                uint32_t i = batch[k];
+                staggered.SetKey(i, simTime, glm::vec3(x[k], y[k], z[k]), target[k]);
+                // the predictor reads the velocity, it only changes with the key
+                bodies.vx[Earth + i] = vx[k] + sunVelocity.x;
+                bodies.vy[Earth + i] = vy[k] + sunVelocity.y;
+                bodies.vz[Earth + i] = vz[k] + sunVelocity.z;
+                glm::vec3 position = staggered.At(i, simTime) + focus;
+                bodies.x[Earth + i] = position.x;
+                bodies.y[Earth + i] = position.y;
+                bodies.z[Earth + i] = position.z;
+            }
+            done += count;
+        }
+        staggered.Carry(done);
+        double keyed = Milliseconds(start);
+        if (reproducible)
+            staggered.Adapt(double(done), ORBIT_REPLAY_KEYS);
+        else
+            staggered.Adapt(keyed, ORBIT_BUDGET_MS);
+        // the slower levels between their keys, with what is left of the budget
+        double maxMs = reproducible ? INFINITY : ORBIT_BUDGET_MS - keyed;
+        size_t maxItems = reproducible ? ORBIT_REPLAY_INTERPOLATED : SIZE_MAX;
+        staggered.Interpolate(simTime, maxMs, maxItems, [&](uint32_t i, const glm::vec3 &at) {
+            glm::vec3 position = at + focus;
+            bodies.x[Earth + i] = position.x;
+            bodies.y[Earth + i] = position.y;
+            bodies.z[Earth + i] = position.z;
+        });
+    });
+    // never waits, the predictor picks the state up when it is free
+    size_t pathSystem = scheduler.Add("paths", PREDICTOR_RATE, 0.1, [&](float) {
+        predictor.Submit(bodies, simTime);
+    });
+
+    // benchmark runs: a scripted camera, a chosen belt size and per-frame CPU and GPU times
+    CameraPath cameraPath;
+    if (!headless.cameraPath.empty() && !cameraPath.Load(headless.cameraPath))
+        return -1;
+    if (headless.frames == 0 && cameraPath.Size() > 0)
+        headless.frames = int(std::ceil(cameraPath.getDuration() / headless.step)) + 1;
+    else if (headless.frames == 0)
+        headless.frames = input.IsReplaying() ? INT_MAX : 600;
+    size_t beltSize = GPU_BELT;
+    if (headless.scene >= 0) {
+        beltSize = size_t(headless.scene);
+        gpu = true;
+    }
+    std::unique_ptr<FrameProfiler> profiler;
+    if (headless.enabled || cameraPath.Size() > 0)
+        profiler.reset(new FrameProfiler());
+    float pathStart = 0.0f;
+
     // render loop
-    while (!glfwWindowShouldClose(window))
+    int frame = 0;
+    int overBudget = 0;
+    while (headless.enabled ? frame < headless.frames : !glfwWindowShouldClose(window))
     {
+        // the one timestamp of the frame, headless frames are a fixed step apart
+        input.NextFrame();
+        if (input.IsFinished())
+            break;
+        if (profiler)
+            profiler->Begin();
         // use time for 1 frame for static camera speed
-        auto currentFrame = float(glfwGetTime());
+        auto currentFrame = float(input.getTime());
         deltaTime = currentFrame - lastFrame;
         timer -= deltaTime;
         if (timer <= 0) {
             dark = !dark;
             timer = TIMER;
         }
+        // shader edits: only compile and link happen here, a program that fails keeps the old one
+        for (const ShaderChange &change : shaderWatcher.Poll())
+        {
+            auto start = std::chrono::steady_clock::now();
+            bool reloaded;
+            if (change.path == EarthVariants.getPath())
+                reloaded = EarthVariants.Reload(change.source);
+            else if (BodiesVariants && change.path == BodiesVariants->getPath())
+                reloaded = BodiesVariants->Reload(change.source);
+            else if (change.path == SunShader.getPath())
+                reloaded = SunShader.Reload(change.source);
+            else if (change.path == OrbitShader.getPath())
+                reloaded = OrbitShader.Reload(change.source);
+            else
+                continue;
+            resolveUniforms();
+            auto end = std::chrono::steady_clock::now();
+            if (reloaded)
+                std::cout << "Reloaded " << change.path << ": "
+                          << std::chrono::duration<double, std::milli>(end - change.saved).count() << " ms after the save, "
+                          << std::chrono::duration<double, std::milli>(end - start).count() << " ms render thread stall" << std::endl;
+            else
+                std::cout << "Failed to reload " << change.path << ", keeping the old program" << std::endl;
+        }
+        // the Earth variant follows the switch, compiled the first time it is needed
+        if (specular != earthSpecular) {
+            EarthShader = &EarthVariants.Get(specular ? std::vector<std::string>{ "SPECULAR" } : std::vector<std::string>{},
+                                             &shaderBatch);
+            EarthUniforms = Uniforms::Earth(*EarthShader);
+            earthSpecular = specular;
+        }
+
         // input
-        processInput(window);
+        for (const InputEvent &event : input.getEvents())
+            handleEvent(window, event);
+        processInput(window, input);
+        if (cameraPath.Size() > 0) {
+            if (frame == 0)
+                pathStart = currentFrame;
+            float pathTime = currentFrame - pathStart;
+            if (!headless.enabled && pathTime > cameraPath.getDuration())
+                glfwSetWindowShouldClose(window, true);
+            CameraKey key = cameraPath.Sample(pathTime);
+            cameraPos = key.position;
+            yaw = key.yaw;
+            pitch = key.pitch;
+            recalculateCameraPos();
+            fov = key.fov;
+            perspective = key.perspective;
+            move = true;
+        }
+
+        // long frames (e.g. the first one) are clamped to keep the orbit stable
+        float simStep = std::min(deltaTime, MAX_STEP);
+
+        if (gpu && !gpuNBody) {
+            if (GpuNBody::IsSupported()) {
+                // the CPU state is copied once, the GPU system then evolves on its own
+                Bodies gpuBodies = bodies;
+                AddBelt(gpuBodies, Sun, beltSize, 30.0f, 45.0f);
+                gpuNBody.reset(new GpuNBody("../res/NBody.shader"));
+                gpuNBody->Upload(gpuBodies);
+                BodiesVariants.reset(new ShaderVariants("../res/Bodies.shader"));
+                BodiesShader = &BodiesVariants->Get({}, &shaderBatch);
+                BodiesSunShader = &BodiesVariants->Get({ "EMISSIVE" }, &shaderBatch);
+                BodiesUniforms = Uniforms::Bodies(*BodiesShader);
+                BodiesSunUniforms = Uniforms::Bodies(*BodiesSunShader);
+                planets = bodies.Size();
+                std::cout << "GPU N-body: " << gpuNBody->getCount() << " bodies" << std::endl;
+            } else {
+                std::cout << "GPU N-body needs OpenGL 4.3" << std::endl;
+                gpu = false;
+            }
+        } else if (!gpu && gpuNBody) {
+            gpuNBody.reset();
+            // the batch must not hold variants that are freed
+            shaderBatch.Finish();
+            BodiesVariants.reset();
+            BodiesShader = BodiesSunShader = nullptr;
+        }
+
+        // programs the driver has finished replace the fallback; headless frames wait for them to stay reproducible
+        if (!shaderBatch.IsDone() && (headless.enabled ? shaderBatch.Finish() : shaderBatch.Poll()))
+            resolveUniforms();
+
+        if (scrubbing && !wasScrubbing) {
+            liveTime = simTime;
+        } else if (!scrubbing && wasScrubbing && !analytic) {
+            // the run continues from the scrubbed time, the history after it is rewritten
+            Reconstruct(simTime);
+            keyframes.Truncate(simTime);
+            for (size_t i = 0; i < bodies.Size(); ++i)
+                predictor.Invalidate(i);
+        }
+        wasScrubbing = scrubbing;
+
+        if (gpuNBody) {
+            float step = std::min(simStep * timeWarp, GPU_STEP * GPU_MAX_SUBSTEPS);
+            bool saturated = step < simStep * timeWarp;
+            if (saturated != gpuSaturated) {
+                if (saturated)
+                    std::cout << "GPU N-body: time warp saturated at " << step / simStep << "x" << std::endl;
+                gpuSaturated = saturated;
+            }
+            // min only against rounding, step / GPU_MAX_SUBSTEPS <= GPU_STEP already
+            int substeps = std::min(int(std::ceil(step / GPU_STEP)), GPU_MAX_SUBSTEPS);
+            gpuNBody->Step(step, std::max(substeps, 1));
+        } else if (scrubbing) {
+            // only recorded history, never past the time scrubbing started
+            double scrubTime = std::max(0.0, std::min(liveTime, simTime + scrubDirection * SCRUB_RATE * timeWarp * simStep));
+            if (scrubTime != simTime) {
+                double previous = simTime;
+                simTime = scrubTime;
+                if (!analytic && !keyframes.Interpolate(simTime, bodies) && !Reconstruct(simTime))
+                    simTime = previous;
+                staggered.Invalidate();
+            }
+            frameSimStep = 0.0f;
+        } else if (analytic) {
+            // the orbits themselves are a scheduled system
+            frameSimStep = simStep * timeWarp;
+            simTime += frameSimStep;
+            integrating = false;
+        } else {
+            // integration continues from the analytic state
+            if (!integrating) {
+                for (size_t i = 0; i < orbits.Size(); ++i) {
+                    glm::vec3 position, velocity;
+                    orbits.State(i, simTime, position, velocity);
+                    velocity += bodies.Velocity(Sun);
+                    bodies.vx[Earth + i] = velocity.x;
+                    bodies.vy[Earth + i] = velocity.y;
+                    bodies.vz[Earth + i] = velocity.z;
+                }
+                integrating = true;
+            }
+            // gravity kernel switched by the user
+            if (nbody.getKernel() != gravityKernel) {
+                nbody.setKernel(gravityKernel);
+                std::cout << "Gravity kernel: " << GravityKernelName(nbody.ActiveKernel()) << std::endl;
+            }
+            if (integrator.getType() != integratorType) {
+                integrator.setType(integratorType);
+                std::cout << "Integrator: " << IntegratorName(integratorType) << std::endl;
+            }
+            integrator.setWarp(timeWarp);
+            simTime += integrator.Advance(simStep);
+
+            // integrated bodies can run into each other, analytic orbits never do
+            collision.Detect(bodies);
+            if (!collision.getContacts().empty()) {
+                collision.Resolve(bodies, 0.5f);
+                for (const Contact &contact : collision.getContacts()) {
+                    predictor.Invalidate(contact.a);
+                    predictor.Invalidate(contact.b);
+                }
+                std::cout << "Collisions: " << collision.getContacts().size() << std::endl;
+            }
+            keyframes.Record(simTime, bodies);
+        }
+
+        if (snapshotSlot != 0) {
+            std::string path = SNAPSHOT_PATH + std::to_string(snapshotSlot) + ".bin";
+            Snapshot snapshot;
+            if (snapshotSave) {
+                SnapshotClock clock{ simTime, timeWarp, analytic, uint32_t(integratorType), 0 };
+                SnapshotCamera camera{ { cameraPos.x, cameraPos.y, cameraPos.z },
+                                       { cameraFront.x, cameraFront.y, cameraFront.z },
+                                       { cameraUp.x, cameraUp.y, cameraUp.z },
+                                       pitch, yaw, theta, phi, fov, perspective, move };
+                if (Snapshot::Save(path, bodies, clock, camera))
+                    std::cout << "Saved " << path << std::endl;
+            } else if (snapshot.Open(path) && snapshot.getBodyCount() >= Earth + orbits.Size()) {
+                snapshot.Restore(bodies);
+                const SnapshotClock &clock = snapshot.getClock();
+                simTime = clock.simTime;
+                timeWarp = clock.timeWarp;
+                analytic = clock.analytic != 0;
+                integratorType = IntegratorType(clock.integrator % 3);
+                // the restored velocities are the ones to integrate from
+                integrating = !analytic;
+                const SnapshotCamera &camera = snapshot.getCamera();
+                cameraPos = glm::vec3(camera.position[0], camera.position[1], camera.position[2]);
+                cameraFront = glm::vec3(camera.front[0], camera.front[1], camera.front[2]);
+                cameraUp = glm::vec3(camera.up[0], camera.up[1], camera.up[2]);
+                pitch = camera.pitch;
+                yaw = camera.yaw;
+                theta = camera.theta;
+                phi = camera.phi;
+                fov = camera.fov;
+                perspective = camera.perspective != 0;
+                move = camera.move != 0;
+                // everything derived from the old state is out of date
+                staggered.Invalidate();
+                keyframes.Clear();
+                for (size_t i = 0; i < bodies.Size(); ++i)
+                    predictor.Invalidate(i);
+                std::cout << "Restored " << path << " at t = " << simTime << std::endl;
+            }
+            snapshotSlot = 0;
+        }
+
+        scheduler.setEnabled(orbitSystem, analytic && !gpuNBody);
+        scheduler.setEnabled(pathSystem, paths && !gpuNBody);
+        scheduler.Tick(deltaTime);
 
         // render
         GLCall(glClearColor(0.12f, 0.08f, 0.11f, 1.0f); );
@@ -198,95 +765,217 @@ int main() {
             view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
         }
 
-        glm::vec3 lightPos(0.0f, 0.0f, 0.0f);
+        // the hierarchy follows the CPU bodies while picking is on
+        if (picking) {
+            if (bvh.getBodyCount() != bodies.Size())
+                bvh.Build(bodies);
+            else
+                bvh.Refit(bodies);
+            if (pickRequested) {
+                glm::vec3 origin, direction;
+                ScreenRay(pickX, pickY, 1, 1, projection, view, origin, direction);
+                RayHit hit{};
+                if (bvh.Raycast(origin, direction, hit))
+                    std::cout << "Picked body " << hit.body << " at distance " << hit.distance << std::endl;
+                else
+                    std::cout << "Nothing picked" << std::endl;
+                pickRequested = false;
+            }
+        }
 
-        // one VBO and IBO for all objects
-        SunVAO.Bind();
-        sphereVBO.Bind();
-        sphereIBO.Bind();
-        {
-            // use Sun shader
-            SunShader.Use();
+        for (size_t i = 0; i < bodies.Size(); ++i)
+            octree.Move(uint32_t(i), bodies.Position(i), bodies.radius[i]);
+        visibleIds.clear();
+        octree.QueryFrustum(Frustum(projection * view), visibleIds);
+        visible.assign(bodies.Size(), 0);
+        for (uint32_t id : visibleIds)
+            visible[id] = 1;
+
+        glm::vec3 lightPos = bodies.Position(Sun);
+
+        // everything the shaders share goes up in one copy
+        Uniforms::FrameBlock frameBlock{};
+        frameBlock.projection = projection;
+        frameBlock.view = view;
+        frameBlock.viewPos = glm::vec3(glm::inverse(view)[3]);
+        frameBlock.lightColor = lightColor;
+        frameBlock.lightPosition = lightPos;
+        frameBlock.lightAmbient = lightAmbient;
+        frameBlock.lightDiffuse = dark ? zeros : lightDiffuse;
+        frameUBO.Update(&frameBlock, sizeof(frameBlock));
+
+        if (gpuNBody) {
+            gpuNBody->BindForDraw();
+            GLCall(glActiveTexture(GL_TEXTURE0); );
+
+            // body 0 is the Sun, then the planets, then the belt
+            SunVAO.Bind();
+            sphereVBO.Bind();
+            sphereIBO.Bind();
+            BodiesSunShader->Use();
             {
-                // set projection and view to shader
-                SunShader.setMat4f("projection", glm::value_ptr(projection));
-                SunShader.setMat4f("view", glm::value_ptr(view));
-
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::scale(model, glm::vec3(5.0f));
-                model = glm::translate(model, lightPos);
-                model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-                SunShader.setMat4f("model", glm::value_ptr(model));
-                SunShader.setVec3f("lightColor", glm::value_ptr(lightColor));
-
-                // check the light state
-                if (dark) {
-                    GLCall(glActiveTexture(GL_TEXTURE0););
-                    GLCall(glBindTexture(GL_TEXTURE_2D, DarkSunTexture););
-                } else {
-                    GLCall(glActiveTexture(GL_TEXTURE0););
-                    GLCall(glBindTexture(GL_TEXTURE_2D, SunTexture););
+                BodiesSunShader->setInt(BodiesSunUniforms.baseInstance, 0);
+                GLCall(glBindTexture(GL_TEXTURE_2D, dark ? DarkSunTexture : SunTexture); );
+                GLCall(glDrawElementsInstanced(GL_TRIANGLES, sphere.getIndices().size(), GL_UNSIGNED_INT, (void *) 0, 1); );
+            }
+            BodiesShader->Use();
+            {
+                BodiesShader->setInt(BodiesUniforms.baseInstance, 1);
+                GLCall(glBindTexture(GL_TEXTURE_2D, EarthTexture); );
+                GLCall(glDrawElementsInstanced(GL_TRIANGLES, sphere.getIndices().size(), GL_UNSIGNED_INT, (void *) 0, GLsizei(planets - 1)); );
+                SunVAO.Unbind();
+
+                BeltVAO.Bind();
+                beltVBO.Bind();
+                beltIBO.Bind();
+                BodiesShader->setInt(BodiesUniforms.baseInstance, int(planets));
+                GLCall(glDrawElementsInstanced(GL_TRIANGLES, beltSphere.getIndices().size(), GL_UNSIGNED_INT, (void *) 0, GLsizei(gpuNBody->getCount() - planets)); );
+                BeltVAO.Unbind();
+                beltVBO.Unbind();
+                beltIBO.Unbind();
+            }
+            BodiesShader->NotUse();
+        } else {
+            // one VBO and IBO for all objects
+            SunVAO.Bind();
+            sphereVBO.Bind();
+            sphereIBO.Bind();
+            {
+                // use Sun shader
+                SunShader.Use();
+                {
+                    glm::mat4 model = glm::mat4(1.0f);
+                    model = glm::translate(model, lightPos);
+                    model = glm::scale(model, glm::vec3(bodies.radius[Sun]));
+                    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+                    SunShader.setMat4f(SunUniforms.model, glm::value_ptr(model));
+
+                    // check the light state
+                    if (dark) {
+                        GLCall(glActiveTexture(GL_TEXTURE0););
+                        GLCall(glBindTexture(GL_TEXTURE_2D, DarkSunTexture););
+                    } else {
+                        GLCall(glActiveTexture(GL_TEXTURE0););
+                        GLCall(glBindTexture(GL_TEXTURE_2D, SunTexture););
+                    }
+
+                    if (visible[Sun]) {
+                        GLCall(glDrawElements(GL_TRIANGLES, sphere.getIndices().size(), GL_UNSIGNED_INT, (void *) 0););
+                    }
                 }
-
-                GLCall(glDrawElements(GL_TRIANGLES, sphere.getIndices().size(), GL_UNSIGNED_INT, (void *) 0););
+                SunShader.NotUse();
             }
-            SunShader.NotUse();
-        }
-        SunVAO.Unbind();
-        sphereVBO.Unbind();
-        sphereIBO.Unbind();
+            SunVAO.Unbind();
+            sphereVBO.Unbind();
+            sphereIBO.Unbind();
 
-        EarthVAO.Bind();
-        sphereVBO.Bind();
-        sphereIBO.Bind();
-        {
-            // use Earth shader
-            EarthShader.Use();
+            EarthVAO.Bind();
+            sphereVBO.Bind();
+            sphereIBO.Bind();
             {
-                // set projection and view to shader
-                EarthShader.setMat4f("projection", glm::value_ptr(projection));
-                EarthShader.setMat4f("view", glm::value_ptr(view));
-//                EarthShader.setVec3f("viewPos", glm::value_ptr(cameraPos));        // specular
-//                EarthShader.setVec3f("lightColor", glm::value_ptr(lightColor));    // specular
-
-                // set light pos and color
-                EarthShader.setVec3f("light.position", glm::value_ptr(lightPos));
-                EarthShader.setVec3f("light.ambient", glm::value_ptr(lightAmbient));
-                EarthShader.setVec3f("light.diffuse", dark ? glm::value_ptr(zeros) : glm::value_ptr(lightDiffuse));
-
-                // Earth correction
-                float EarthRadius = 10.0f;
-                glm::vec3 rotationVec(0.0f, 1.0f, 0.0f);
-                glm::vec3 EarthPos(EarthRadius*sin(glfwGetTime()), 0.0f, EarthRadius*cos(glfwGetTime()));
-                EarthRotationAngle += 300.0f*deltaTime;
-
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::scale(model, glm::vec3(2.0f));
-                model = glm::translate(model, EarthPos);
-                model = glm::rotate(model, glm::radians(-23.5f), glm::vec3(0.0f, 0.0f, 1.0f));
-                model = glm::rotate(model, -glm::radians(EarthRotationAngle), rotationVec);
-                model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-
-                EarthShader.setMat4f("model", glm::value_ptr(model));
-//                EarthShader.setVec3f("ourColor", glm::value_ptr(ourColor));  // specular
-
-                GLCall(glActiveTexture(GL_TEXTURE0); );
-                GLCall(glBindTexture(GL_TEXTURE_2D, EarthTexture); );
+                // use Earth shader
+                EarthShader->Use();
+                {
+                    // Earth correction
+                    glm::vec3 rotationVec(0.0f, 1.0f, 0.0f);
+                    glm::vec3 EarthPos = bodies.Position(Earth);
+                    EarthRotationAngle += 300.0f*deltaTime;
+
+                    glm::mat4 model = glm::mat4(1.0f);
+                    model = glm::translate(model, EarthPos);
+                    model = glm::scale(model, glm::vec3(bodies.radius[Earth]));
+                    model = glm::rotate(model, glm::radians(-23.5f), glm::vec3(0.0f, 0.0f, 1.0f));
+                    model = glm::rotate(model, -glm::radians(EarthRotationAngle), rotationVec);
+                    model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+                    EarthShader->setMat4f(EarthUniforms.model, glm::value_ptr(model));
+
+                    GLCall(glActiveTexture(GL_TEXTURE0); );
+                    GLCall(glBindTexture(GL_TEXTURE_2D, EarthTexture); );
+
+                    if (visible[Earth]) {
+                        GLCall( glDrawElements(GL_TRIANGLES, sphere.getIndices().size(), GL_UNSIGNED_INT, (void*) 0); );
+                    }
+                }
+                EarthShader->NotUse();
+            }
+            EarthVAO.Unbind();
+            sphereVBO.Unbind();
+            sphereIBO.Unbind();
+
+            if (paths) {
+                // a new upload only when the predictor has published since the last frame
+                if (predictor.Acquire()) {
+                    const Polylines &polylines = predictor.getPolylines();
+                    orbitVBO.Update(polylines.vertices.data(), polylines.vertices.size()*sizeof(float));
+                    orbitVBO.Unbind();
+                    orbitGeneration = polylines.generation;
+                }
+                const Polylines &polylines = predictor.getPolylines();
+                if (orbitGeneration != 0) {
+                    OrbitVAO.Bind();
+                    OrbitShader.Use();
+                    OrbitShader.setVec3f(OrbitUniforms.color, glm::value_ptr(orbitColor));
+                    GLCall(glMultiDrawArrays(GL_LINE_STRIP, polylines.first.data(), polylines.count.data(), GLsizei(polylines.first.size())); );
+                    OrbitShader.NotUse();
+                    OrbitVAO.Unbind();
+                }
+            }
+        }
 
-                GLCall( glDrawElements(GL_TRIANGLES, sphere.getIndices().size(), GL_UNSIGNED_INT, (void*) 0); );
+        if (profiler)
+            profiler->End();
+        if (headless.enabled) {
+            // frames written out are not part of the frame time
+            GLCall(glFinish());
+            if (!headless.output.empty() && !headless.nullGL && frame % headless.every == 0) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/frame%05d.%s", frame, headless.format == ImageFormat::PNG ? "png" : "ppm");
+                offscreen.WriteFrame(headless.output + name, headless.format);
             }
-            EarthShader.NotUse();
+        } else {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
-        EarthVAO.Unbind();
-        sphereVBO.Unbind();
-        sphereIBO.Unbind();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        if (headless.glStats) {
+            GLIntercept::Frame calls = GLIntercept::EndFrame(true);
+            uint32_t total = 0;
+            for (uint32_t count : calls.calls)
+                total += count;
+            if (headless.glBudget > 0 && total > uint32_t(headless.glBudget))
+                ++overBudget;
+        }
 
         lastFrame = currentFrame;
+        ++frame;
+    }
+
+    if (headless.glStats) {
+        GLIntercept::PrintTotals();
+        GLIntercept::Close();
     }
+    if (overBudget > 0)
+        std::cout << overBudget << " frames over the budget of " << headless.glBudget << " GL calls" << std::endl;
+
+    if (profiler) {
+        profiler->Finish();
+        profiler->Print();
+        if (!headless.report.empty()) {
+            std::string renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+            profiler->WriteJson(headless.report, {
+                    { "path", "\"" + headless.cameraPath + "\"" },
+                    { "scene", std::to_string(gpuNBody ? gpuNBody->getCount() : bodies.Size()) },
+                    { "width", std::to_string(SCR_WIDTH) },
+                    { "height", std::to_string(SCR_HEIGHT) },
+                    { "headless", headless.enabled ? "true" : "false" },
+                    { "renderer", "\"" + renderer + "\"" } });
+        }
+        profiler.reset();
+    }
+    if (headless.enabled)
+        return overBudget > 0 ? 1 : 0;
 
     // glfw end
     glfwTerminate();
@@ -302,46 +991,121 @@ void recalculateCameraPos() {
     cameraFront = glm::normalize(direction);
 }
 
-void processInput(GLFWwindow *window)
+void processInput(GLFWwindow *window, const InputSource &input)
 {
     float moveCameraSpeed = 5.0f*deltaTime;
     float rotateCameraSpeed = 100.0f*deltaTime;
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_UP))
         theta = fmod((theta - rotateCameraSpeed + 360.0f), 360.0f);
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_DOWN))
         theta = fmod((theta + rotateCameraSpeed), 360.0f);
-    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_RIGHT))
         phi = fmod((phi - rotateCameraSpeed), 360.0f);
-    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_LEFT))
         phi = fmod((phi + rotateCameraSpeed), 360.0f);
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_W))
         cameraPos += moveCameraSpeed * cameraFront;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_S))
         cameraPos -= moveCameraSpeed * cameraFront;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_A))
         cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * moveCameraSpeed;
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (input.Held(GLFW_KEY_D))
         cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * moveCameraSpeed;
 
     recalculateCameraPos();
 
-    if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    scrubDirection = 0.0f;
+    if (input.Held(GLFW_KEY_LEFT_BRACKET))
+        scrubDirection -= 1.0f;
+    if (input.Held(GLFW_KEY_RIGHT_BRACKET))
+        scrubDirection += 1.0f;
+
+    if (input.Held(GLFW_KEY_ESCAPE) && window != nullptr)
         glfwSetWindowShouldClose(window, true);
 }
 
+// recorded or live GLFW callbacks, in the order they arrived
+void handleEvent(GLFWwindow *window, const InputEvent &event)
+{
+    switch (event.type) {
+        case InputEventType::KEY:
+            key_callback(window, event.code, 0, event.action, event.mods);
+            break;
+        case InputEventType::CURSOR:
+            cursor_position_callback(window, event.x, event.y);
+            break;
+        case InputEventType::SCROLL:
+            scroll_callback(window, event.x, event.y);
+            break;
+        case InputEventType::MOUSE_BUTTON:
+            mouse_button_callback(window, event.code, event.action, event.mods, event.x, event.y);
+            break;
+        case InputEventType::RESIZE:
+            framebuffer_size_callback(window, int(event.x), int(event.y));
+            break;
+    }
+}
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
         perspective = true;
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
+    if (key == GLFW_KEY_O && action == GLFW_PRESS)
         perspective = false;
-    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS)
+    if (key == GLFW_KEY_M && action == GLFW_PRESS)
         move = !move;
+    if (key == GLFW_KEY_G && action == GLFW_PRESS)
+        gravityKernel = GravityKernel((int(gravityKernel) + 1) % 4);
+    if (key == GLFW_KEY_K && action == GLFW_PRESS)
+        analytic = !analytic;
+    if (key == GLFW_KEY_C && action == GLFW_PRESS)
+        gpu = !gpu;
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        picking = !picking;
+        if (window != nullptr)
+            glfwSetInputMode(window, GLFW_CURSOR, picking ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+        // no camera jump when the mouse look comes back
+        firstPressed = true;
+    }
+    if (key >= GLFW_KEY_1 && key <= GLFW_KEY_4 && action == GLFW_PRESS) {
+        snapshotSlot = key - GLFW_KEY_0;
+        snapshotSave = (mods & GLFW_MOD_SHIFT) != 0;
+    }
+    if (key == GLFW_KEY_Z && action == GLFW_PRESS) {
+        scrubbing = !scrubbing;
+        std::cout << (scrubbing ? "Scrubbing" : "Running") << std::endl;
+    }
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+        paths = !paths;
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+        specular = !specular;
+    if (key == GLFW_KEY_I && action == GLFW_PRESS)
+        integratorType = IntegratorType((int(integratorType) + 1) % 3);
+    if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS && timeWarp < 10000.0f) {
+        timeWarp *= 10.0f;
+        std::cout << "Time warp: " << timeWarp << "x" << std::endl;
+    }
+    if (key == GLFW_KEY_MINUS && action == GLFW_PRESS && timeWarp > 1.0f) {
+        timeWarp /= 10.0f;
+        std::cout << "Time warp: " << timeWarp << "x" << std::endl;
+    }
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods, double x, double y)
+{
+    if (picking && button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+        pickX = x;
+        pickY = y;
+        pickRequested = true;
+    }
 }
 
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
 {
+    // the free cursor points at bodies instead of turning the camera
+    if (picking)
+        return;
     if (firstPressed)
     {
         lastX = float(xpos);
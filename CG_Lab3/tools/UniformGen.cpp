@@ -0,0 +1,373 @@
+//
+// Created by max on 19.10.26.
+//
+
+// uniformgen output.h file.shader...
+// writes ShaderUniforms.h: per .shader file a struct of the UniformIds of its plain uniforms, resolved
+// by names hashed at compile time, and per std140 uniform block a struct laid out byte for byte like
+// the block, so a frame's values go to the GPU in one copy. a name that is not in the shaders is
+// a compile error instead of a -1 location at run time
+
+#include "../src/UniformHash.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// as SHADER_INCLUDE_DEPTH of Shader.h
+#define INCLUDE_DEPTH 16
+
+struct Member
+{
+    std::string type;
+    std::string name;
+    bool array;
+};
+
+struct Block
+{
+    std::string file;               // first file declaring it
+    std::vector<Member> members;
+};
+
+struct Program
+{
+    std::string name;               // file name without directory and extension
+    std::string file;
+    std::vector<Member> uniforms;   // struct members flattened to "name.member"
+};
+
+// std140 base alignment and size of a block member, and the C++ type with that layout
+struct Std140Type
+{
+    const char *glsl;
+    const char *cpp;
+    size_t align;
+    size_t size;
+};
+
+// matrices are arrays of vec4 columns, bools are 4 bytes
+static const Std140Type STD140[] = {
+        { "float", "float", 4, 4 }, { "int", "int32_t", 4, 4 }, { "uint", "uint32_t", 4, 4 }, { "bool", "int32_t", 4, 4 },
+        { "vec2", "glm::vec2", 8, 8 }, { "vec3", "glm::vec3", 16, 12 }, { "vec4", "glm::vec4", 16, 16 },
+        { "ivec2", "glm::ivec2", 8, 8 }, { "ivec3", "glm::ivec3", 16, 12 }, { "ivec4", "glm::ivec4", 16, 16 },
+        { "uvec2", "glm::uvec2", 8, 8 }, { "uvec3", "glm::uvec3", 16, 12 }, { "uvec4", "glm::uvec4", 16, 16 },
+        { "mat2", "glm::mat2x4", 16, 32 }, { "mat3", "glm::mat3x4", 16, 48 }, { "mat4", "glm::mat4", 16, 64 }
+};
+
+static bool failed = false;
+
+static void Fail(const std::string &file, const std::string &message)
+{
+    std::cout << file << ": " << message << std::endl;
+    failed = true;
+}
+
+// the file with includes expanded as Shader::Parse does, without comments and other preprocessor lines.
+// #ifdef is ignored, so every variant's uniforms are in
+static void Expand(const std::string &path, std::string &text, int depth)
+{
+    std::ifstream stream(path);
+    if (depth > INCLUDE_DEPTH || !stream.is_open()) {
+        Fail(path, depth > INCLUDE_DEPTH ? "includes nested too deep" : "cannot open");
+        return;
+    }
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    std::string line;
+    while (getline(stream, line))
+    {
+        line = line.substr(0, line.find("//"));
+        size_t start = line.find_first_not_of(" \t");
+        if (start != std::string::npos && line[start] == '#') {
+            size_t open = line.find('"'), close = line.rfind('"');
+            if (line.compare(start, 8, "#include") == 0 && open != close)
+                Expand(directory + line.substr(open + 1, close - open - 1), text, depth + 1);
+            continue;
+        }
+        text += line + '\n';
+    }
+}
+
+// identifiers and numbers as one token each, everything else a character at a time
+static std::vector<std::string> Tokenize(const std::string &text)
+{
+    std::vector<std::string> tokens;
+    for (size_t i = 0; i < text.size();)
+    {
+        if (std::isspace((unsigned char) text[i])) {
+            ++i;
+        } else if (std::isalnum((unsigned char) text[i]) || text[i] == '_') {
+            size_t end = i;
+            while (end < text.size() && (std::isalnum((unsigned char) text[end]) || text[end] == '_'))
+                ++end;
+            tokens.push_back(text.substr(i, end - i));
+            i = end;
+        } else {
+            tokens.push_back(text.substr(i++, 1));
+        }
+    }
+    return tokens;
+}
+
+// "type name, name[N];" up to the closing brace, i from the opening one to the closing one
+static std::vector<Member> Members(const std::vector<std::string> &tokens, size_t &i)
+{
+    std::vector<Member> members;
+    std::string type;
+    for (++i; i < tokens.size() && tokens[i] != "}"; ++i)
+    {
+        const std::string &token = tokens[i];
+        if (token == ";") {
+            type.clear();
+        } else if (token == "," || token == "lowp" || token == "mediump" || token == "highp") {
+            continue;
+        } else if (token == "[") {
+            while (i < tokens.size() && tokens[i] != "]")
+                ++i;
+            if (!members.empty())
+                members.back().array = true;
+        } else if (type.empty()) {
+            type = token;
+        } else {
+            members.push_back({ type, token, false });
+        }
+    }
+    return members;
+}
+
+// appends the uniform, or every member of it when its type is one of the structs
+static void Flatten(const Member &uniform, const std::map<std::string, std::vector<Member>> &structs,
+                    std::vector<Member> &uniforms)
+{
+    auto it = structs.find(uniform.type);
+    if (it == structs.end()) {
+        uniforms.push_back(uniform);
+        return;
+    }
+    for (const Member &member : it->second)
+        Flatten({ member.type, uniform.name + "." + member.name, member.array }, structs, uniforms);
+}
+
+static void Scan(Program &program, std::map<std::string, Block> &blocks)
+{
+    std::string text;
+    Expand(program.file, text, 0);
+    std::vector<std::string> tokens = Tokenize(text);
+    std::map<std::string, std::vector<Member>> structs;
+    std::vector<Member> uniforms;
+    // whether the declaration being read started with a layout naming std140
+    bool std140 = false;
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        const std::string &token = tokens[i];
+        if (token == ";" || token == "}") {
+            std140 = false;
+        } else if (token == "std140") {
+            std140 = true;
+        } else if (token == "struct" && i + 2 < tokens.size() && tokens[i + 2] == "{") {
+            std::string name = tokens[i + 1];
+            i += 2;
+            structs[name] = Members(tokens, i);
+            std140 = false;
+        } else if (token == "uniform" && i + 2 < tokens.size() && tokens[i + 2] == "{") {
+            std::string name = tokens[i + 1];
+            bool layout = std140;
+            i += 2;
+            std::vector<Member> members = Members(tokens, i);
+            std140 = false;
+            if (!layout) {
+                Fail(program.file, "uniform block " + name + " has no std140 layout");
+                continue;
+            }
+            auto it = blocks.find(name);
+            if (it == blocks.end()) {
+                blocks[name] = { program.file, members };
+                continue;
+            }
+            bool same = it->second.members.size() == members.size();
+            for (size_t k = 0; same && k < members.size(); ++k)
+                same = members[k].type == it->second.members[k].type && members[k].name == it->second.members[k].name;
+            if (!same)
+                Fail(program.file, "uniform block " + name + " differs from the one in " + it->second.file);
+        } else if (token == "uniform" && i + 1 < tokens.size()) {
+            std::string type = tokens[++i];
+            // declarators up to the semicolon, initializers skipped
+            int depth = 0;
+            bool name = true;
+            for (++i; i < tokens.size() && !(depth == 0 && tokens[i] == ";"); ++i)
+            {
+                const std::string &part = tokens[i];
+                if (part == "(" || part == "[")
+                    ++depth;
+                else if (part == ")" || part == "]")
+                    --depth;
+                else if (depth == 0 && part == "=")
+                    name = false;
+                else if (depth == 0 && part == ",")
+                    name = true;
+                else if (depth == 0 && name) {
+                    Flatten({ type, part, false }, structs, uniforms);
+                    name = false;
+                }
+            }
+            std140 = false;
+        }
+    }
+
+    // once per name across stages and variants
+    std::map<std::string, std::string> types;
+    for (const Member &uniform : uniforms)
+    {
+        auto it = types.find(uniform.name);
+        if (it == types.end()) {
+            types[uniform.name] = uniform.type;
+            program.uniforms.push_back(uniform);
+        } else if (it->second != uniform.type) {
+            Fail(program.file, "uniform " + uniform.name + " is " + it->second + " and " + uniform.type);
+        }
+    }
+}
+
+// "material.diffuse" -> materialDiffuse
+static std::string Identifier(const std::string &name)
+{
+    std::string identifier;
+    bool upper = false;
+    for (char c : name)
+    {
+        if (c == '.') {
+            upper = true;
+        } else {
+            identifier += upper ? char(std::toupper((unsigned char) c)) : c;
+            upper = false;
+        }
+    }
+    return identifier;
+}
+
+static const Std140Type *Std140(const std::string &glsl)
+{
+    for (const Std140Type &type : STD140)
+        if (glsl == type.glsl)
+            return &type;
+    return nullptr;
+}
+
+static void WriteBlock(std::ostream &out, const std::string &name, const Block &block, unsigned int binding)
+{
+    std::string type = name + "Block";
+    std::ostringstream asserts;
+    out << "// uniform block " << name << ", std140, at buffer binding " << binding << "\n";
+    out << "struct " << type << "\n{\n";
+    out << "    static constexpr const char *Name = \"" << name << "\";\n";
+    out << "    static constexpr unsigned int Binding = " << binding << ";\n\n";
+    size_t offset = 0;
+    int pads = 0;
+    for (const Member &member : block.members)
+    {
+        const Std140Type *layout = Std140(member.type);
+        if (layout == nullptr || member.array) {
+            Fail(block.file, "uniform block " + name + ": " + member.type + (member.array ? " array " : " ")
+                             + member.name + " is not supported");
+            continue;
+        }
+        size_t aligned = (offset + layout->align - 1) / layout->align * layout->align;
+        if (aligned > offset)
+            out << "    float pad" << pads++ << "[" << (aligned - offset) / 4 << "];\n";
+        out << "    " << layout->cpp << " " << member.name << ";\n";
+        asserts << "static_assert(offsetof(" << type << ", " << member.name << ") == " << aligned
+                << ", \"" << type << "::" << member.name << " is off its std140 offset\");\n";
+        offset = aligned + layout->size;
+    }
+    // the block size rounds up to a vec4
+    size_t size = (offset + 15) / 16 * 16;
+    if (size > offset)
+        out << "    float pad" << pads << "[" << (size - offset) / 4 << "];\n";
+    out << "};\n" << asserts.str();
+    out << "static_assert(sizeof(" << type << ") == " << size << ", \"" << type << " is not the std140 size\");\n\n";
+}
+
+static void WriteProgram(std::ostream &out, const Program &program)
+{
+    out << "// " << program.file.substr(program.file.find_last_of('/') + 1)
+        << ", uniforms outside blocks; -1 for those a variant leaves out\n";
+    out << "struct " << program.name << "\n{\n";
+    for (const Member &uniform : program.uniforms)
+        out << "    UniformId " << Identifier(uniform.name) << ";" << std::string(std::max<size_t>(1, 24 - Identifier(uniform.name).size()), ' ')
+            << "// " << uniform.type << (Identifier(uniform.name) != uniform.name ? " " + uniform.name : "") << "\n";
+    if (!program.uniforms.empty())
+        out << "\n";
+    out << "    " << program.name << "() = default;\n";
+    out << "    explicit " << program.name << "(const Shader &shader)";
+    for (size_t k = 0; k < program.uniforms.size(); ++k)
+    {
+        std::string identifier = Identifier(program.uniforms[k].name);
+        out << (k == 0 ? "\n            : " : ",\n              ") << identifier << "(shader.Uniform(Id::" << identifier << "))";
+    }
+    out << " {}\n};\n\n";
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " output.h file.shader..." << std::endl;
+        return 1;
+    }
+    std::vector<Program> programs;
+    std::map<std::string, Block> blocks;
+    for (int k = 2; k < argc; ++k)
+    {
+        std::string file = argv[k];
+        std::string name = file.substr(file.find_last_of('/') + 1);
+        programs.push_back({ name.substr(0, name.find('.')), file, {} });
+        Scan(programs.back(), blocks);
+    }
+
+    // the ids, and two names on one hash would be one uniform to Shader
+    std::map<std::string, std::string> ids;
+    std::map<uint32_t, std::string> hashes;
+    for (const Program &program : programs)
+        for (const Member &uniform : program.uniforms)
+        {
+            auto it = ids.find(Identifier(uniform.name));
+            if (it != ids.end() && it->second != uniform.name)
+                Fail(program.file, "uniforms " + it->second + " and " + uniform.name + " share the name " + it->first);
+            ids[Identifier(uniform.name)] = uniform.name;
+            std::string &other = hashes[UniformHash(uniform.name.c_str())];
+            if (!other.empty() && other != uniform.name)
+                Fail(program.file, "uniforms " + other + " and " + uniform.name + " hash alike");
+            other = uniform.name;
+        }
+
+    std::ostringstream out;
+    out << "// generated by uniformgen from the .shader files, do not edit\n\n";
+    out << "#ifndef PROJECT_SHADERUNIFORMS_H\n#define PROJECT_SHADERUNIFORMS_H\n\n";
+    out << "#include <cstddef>\n#include <cstdint>\n#include <glm/glm.hpp>\n#include \"Shader.h\"\n#include \"UniformHash.h\"\n\n";
+    out << "namespace Uniforms {\n\n";
+    out << "// hashed names, the keys of Shader::Uniform\nnamespace Id {\n";
+    for (const auto &id : ids)
+        out << "constexpr uint32_t " << id.first << " = UniformHash(\"" << id.second << "\");\n";
+    out << "}\n\n";
+    unsigned int binding = 0;
+    for (const auto &block : blocks)
+        WriteBlock(out, block.first, block.second, binding++);
+    for (const Program &program : programs)
+        WriteProgram(out, program);
+    out << "}\n\n\n#endif //PROJECT_SHADERUNIFORMS_H\n";
+    if (failed)
+        return 1;
+
+    std::ofstream file(argv[1]);
+    file << out.str();
+    if (!file) {
+        std::cout << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}